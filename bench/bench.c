@@ -0,0 +1,192 @@
+#include <bench.h>
+#include <bench_commit.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <utils.h>
+
+static int compareDoubles(const void *a, const void *b);
+static void writeJsonString(FILE *out, const char *str);
+
+bool bench_Init(BenchReport *report, const char *benchmark, uint32_t defaultIterations, int *argc, char **argv) {
+    memset(report, 0, sizeof(*report));
+    report->benchmark = benchmark;
+    report->iterations = defaultIterations;
+    strcpy(report->deviceName, "none");
+
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            if (i + 1 >= *argc)
+                return false;
+            report->outputPath = argv[++i];
+        } else if (strcmp(argv[i], "--iterations") == 0) {
+            if (i + 1 >= *argc)
+                return false;
+            char *end;
+            unsigned long iterations = strtoul(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || iterations > UINT32_MAX)
+                return false;
+            report->iterations = (uint32_t)iterations;
+        } else {
+            // Left for the benchmark's own parser, which rejects anything it doesn't know
+            argv[kept++] = argv[i];
+        }
+    }
+    *argc = kept;
+
+    return report->iterations > 0;
+}
+
+void bench_SkipIfNoVulkan(void) {
+    if (!vkLoader_Init()) {
+        fprintf(stderr, "No Vulkan loader installed, skipping.\n");
+        exit(BENCH_SKIP_RETURN_CODE);
+    }
+
+    VkApplicationInfo appInfo = {0};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.apiVersion = VK_API_VERSION_1_0;
+
+    VkInstanceCreateInfo createInfo = {0};
+    createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    createInfo.pApplicationInfo = &appInfo;
+
+    VkInstance instance = VK_NULL_HANDLE;
+    uint32_t deviceCount = 0;
+    if (vkCreateInstance(&createInfo, NULL, &instance) == VK_SUCCESS) {
+        vkLoader_LoadInstance(instance);
+        vkEnumeratePhysicalDevices(instance, &deviceCount, NULL);
+        vkDestroyInstance(instance, NULL);
+    }
+
+    if (deviceCount == 0) {
+        fprintf(stderr, "No Vulkan device available (install lavapipe to run on machines without a GPU), skipping.\n");
+        exit(BENCH_SKIP_RETURN_CODE);
+    }
+}
+
+void bench_ConfigureHeadlessApp(App *app) {
+    app->headless = true;
+    app->disableValidation = true;
+}
+
+void bench_InitHeadlessApp(BenchReport *report, App *app) {
+    bench_ConfigureHeadlessApp(app);
+    app_InitVulkan(app);
+    bench_SetDevice(report, app);
+}
+
+void bench_SetDevice(BenchReport *report, const App *app) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(app->physicalDevice, &properties);
+    strncpy(report->deviceName, properties.deviceName, sizeof(report->deviceName) - 1);
+    report->validationEnabled = app->validationEnabled;
+}
+
+void bench_AddValue(BenchReport *report, const char *name, const char *unit, double value) {
+    bench_AddSamples(report, name, unit, &value, 1);
+}
+
+void bench_AddSamples(BenchReport *report, const char *name, const char *unit, const double *samples, uint32_t sampleCount) {
+    if (report->metricCount >= BENCH_MAX_METRICS || sampleCount == 0) {
+        THROW("bench_AddSamples: too many metrics or no samples");
+    }
+
+    double *sorted = (double *)malloc(sampleCount * sizeof(double));
+    if (!sorted) {
+        THROW("malloc fail in bench_AddSamples");
+    }
+    memcpy(sorted, samples, sampleCount * sizeof(double));
+    qsort(sorted, sampleCount, sizeof(double), compareDoubles);
+
+    double sum = 0.0;
+    for (uint32_t i = 0; i < sampleCount; i++) {
+        sum += sorted[i];
+    }
+    double mean = sum / sampleCount;
+
+    double variance = 0.0;
+    for (uint32_t i = 0; i < sampleCount; i++) {
+        variance += (sorted[i] - mean) * (sorted[i] - mean);
+    }
+
+    BenchMetric *metric = &report->metrics[report->metricCount++];
+    metric->name = name;
+    metric->unit = unit;
+    metric->sampleCount = sampleCount;
+    metric->mean = mean;
+    metric->median = (sampleCount % 2) ? sorted[sampleCount / 2] : (sorted[sampleCount / 2 - 1] + sorted[sampleCount / 2]) / 2.0;
+    metric->min = sorted[0];
+    metric->max = sorted[sampleCount - 1];
+    metric->stddev = sampleCount > 1 ? sqrt(variance / (sampleCount - 1)) : 0.0;
+
+    free(sorted);
+}
+
+void bench_WriteJson(const BenchReport *report) {
+    FILE *out = stdout;
+    if (report->outputPath) {
+        out = fopen(report->outputPath, "w");
+        if (!out) {
+            THROW("Failed to open benchmark output file");
+        }
+    }
+
+    fprintf(out, "{\n  \"benchmark\": ");
+    writeJsonString(out, report->benchmark);
+    fprintf(out, ",\n  \"commit\": ");
+    writeJsonString(out, BENCH_GIT_COMMIT);
+    fprintf(out, ",\n  \"timestamp\": %lld", (long long)time(NULL));
+    fprintf(out, ",\n  \"device\": ");
+    writeJsonString(out, report->deviceName);
+    fprintf(out, ",\n  \"validation\": %s", report->validationEnabled ? "true" : "false");
+    fprintf(out, ",\n  \"iterations\": %u", report->iterations);
+    fprintf(out, ",\n  \"metrics\": [");
+
+    for (uint32_t i = 0; i < report->metricCount; i++) {
+        const BenchMetric *m = &report->metrics[i];
+        fprintf(out, "%s\n    {\"name\": ", i == 0 ? "" : ",");
+        writeJsonString(out, m->name);
+        fprintf(out, ", \"unit\": ");
+        writeJsonString(out, m->unit);
+        fprintf(out, ", \"samples\": %u, \"mean\": %.6g, \"median\": %.6g, \"min\": %.6g, \"max\": %.6g, \"stddev\": %.6g}",
+                m->sampleCount, m->mean, m->median, m->min, m->max, m->stddev);
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+}
+
+double bench_NsToMs(uint64_t ns) {
+    return (double)ns / 1e6;
+}
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+static int compareDoubles(const void *a, const void *b) {
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static void writeJsonString(FILE *out, const char *str) {
+    fputc('"', out);
+    for (const char *c = str; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', out);
+            fputc(*c, out);
+        } else if ((unsigned char)*c < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned char)*c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
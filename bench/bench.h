@@ -0,0 +1,54 @@
+#pragma once
+
+#include <app.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BENCH_MAX_METRICS 32
+
+// ctest treats this exit code as "skipped" (see SKIP_RETURN_CODE in CMakeLists.txt)
+#define BENCH_SKIP_RETURN_CODE 77
+
+typedef struct BenchMetric {
+    const char *name;
+    const char *unit;
+    uint32_t sampleCount;
+    double mean;
+    double median;
+    double min;
+    double max;
+    double stddev;
+} BenchMetric;
+
+typedef struct BenchReport {
+    const char *benchmark;
+    char deviceName[VK_MAX_PHYSICAL_DEVICE_NAME_SIZE];
+    bool validationEnabled; // Validation layers add per-call overhead, so results with them on aren't comparable
+    const char *outputPath; // NULL writes the JSON to stdout
+    uint32_t iterations;
+    BenchMetric metrics[BENCH_MAX_METRICS];
+    uint32_t metricCount;
+} BenchReport;
+
+// Handles the arguments shared by every benchmark (--json <path>, --iterations <n>) and removes them from argv,
+// so the benchmark can parse what is left. Returns false on a malformed argument.
+bool bench_Init(BenchReport *report, const char *benchmark, uint32_t defaultIterations, int *argc, char **argv);
+
+// Exits with BENCH_SKIP_RETURN_CODE when no Vulkan implementation (not even lavapipe) is available
+void bench_SkipIfNoVulkan(void);
+
+// Makes app headless with validation layers off, the way every benchmark runs it. Options already set on app
+// (e.g. captureFileName) are kept.
+void bench_ConfigureHeadlessApp(App *app);
+
+// bench_ConfigureHeadlessApp, app_InitVulkan, then bench_SetDevice
+void bench_InitHeadlessApp(BenchReport *report, App *app);
+
+// Records the device of an initialised app and whether validation was on
+void bench_SetDevice(BenchReport *report, const App *app);
+void bench_AddValue(BenchReport *report, const char *name, const char *unit, double value);
+void bench_AddSamples(BenchReport *report, const char *name, const char *unit, const double *samples, uint32_t sampleCount);
+void bench_WriteJson(const BenchReport *report);
+
+double bench_NsToMs(uint64_t ns);
@@ -0,0 +1,107 @@
+// Allocation throughput: raw vkAllocateMemory/vkFreeMemory, full buffer creation through createBuffer, and
+// host writes into mapped host-visible memory.
+
+#include <app.h>
+#include <bench.h>
+#include <buffers.h>
+#include <utils.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALLOC_SIZE_COUNT 3
+
+static const VkDeviceSize allocSizes[ALLOC_SIZE_COUNT] = { 64 * 1024, 1024 * 1024, 16 * 1024 * 1024 };
+static const char *allocMetricNames[ALLOC_SIZE_COUNT] = { "allocate_free_64k", "allocate_free_1m", "allocate_free_16m" };
+static const char *bufferMetricNames[ALLOC_SIZE_COUNT] = { "create_destroy_buffer_64k", "create_destroy_buffer_1m", "create_destroy_buffer_16m" };
+
+int main(int argc, char **argv) {
+    BenchReport report;
+    if (!bench_Init(&report, "allocation_throughput", 200, &argc, argv) || argc > 1) {
+        fprintf(stderr, "Usage: %s [--iterations N] [--json PATH]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    bench_SkipIfNoVulkan();
+
+    App app = {0};
+    bench_InitHeadlessApp(&report, &app);
+
+    const VkMemoryPropertyFlags hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    // Probe a buffer once to learn which memory types buffers can live in
+    VkBuffer probe;
+    VkDeviceMemory probeMemory;
+    createBuffer(app.physicalDevice, app.device, allocSizes[0], VK_BUFFER_USAGE_TRANSFER_SRC_BIT, hostVisible, &probe, &probeMemory);
+    VkMemoryRequirements probeRequirements;
+    vkGetBufferMemoryRequirements(app.device, probe, &probeRequirements);
+    vkDestroyBuffer(app.device, probe, NULL);
+    vkFreeMemory(app.device, probeMemory, NULL);
+    const uint32_t memoryType = findMemoryType(app.physicalDevice, probeRequirements.memoryTypeBits, hostVisible);
+
+    double *samples = (double *)malloc(report.iterations * sizeof(double));
+    if (!samples) {
+        THROW("malloc fail in bench_alloc");
+    }
+
+    for (uint32_t s = 0; s < ALLOC_SIZE_COUNT; s++) {
+        for (uint32_t i = 0; i < report.iterations; i++) {
+            VkMemoryAllocateInfo allocInfo = {0};
+            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocInfo.allocationSize = allocSizes[s];
+            allocInfo.memoryTypeIndex = memoryType;
+
+            VkDeviceMemory memory;
+            uint64_t t0 = timeNowNs();
+            if (vkAllocateMemory(app.device, &allocInfo, NULL, &memory) != VK_SUCCESS) {
+                THROW("Failed to allocate memory!");
+            }
+            vkFreeMemory(app.device, memory, NULL);
+            samples[i] = (double)(timeNowNs() - t0) / 1e3;
+        }
+        bench_AddSamples(&report, allocMetricNames[s], "us", samples, report.iterations);
+
+        for (uint32_t i = 0; i < report.iterations; i++) {
+            VkBuffer buffer;
+            VkDeviceMemory memory;
+            uint64_t t0 = timeNowNs();
+            createBuffer(app.physicalDevice, app.device, allocSizes[s], VK_BUFFER_USAGE_TRANSFER_SRC_BIT, hostVisible, &buffer, &memory);
+            vkDestroyBuffer(app.device, buffer, NULL);
+            vkFreeMemory(app.device, memory, NULL);
+            samples[i] = (double)(timeNowNs() - t0) / 1e3;
+        }
+        bench_AddSamples(&report, bufferMetricNames[s], "us", samples, report.iterations);
+    }
+
+    // Host write bandwidth into mapped memory, the path every staging upload goes through
+    const VkDeviceSize uploadSize = allocSizes[ALLOC_SIZE_COUNT - 1];
+    VkBuffer staging;
+    VkDeviceMemory stagingMemory;
+    createBuffer(app.physicalDevice, app.device, uploadSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, hostVisible, &staging, &stagingMemory);
+
+    void *source = malloc(uploadSize);
+    if (!source) {
+        THROW("malloc fail in bench_alloc");
+    }
+    memset(source, 0xAB, uploadSize);
+
+    void *mapped;
+    vkMapMemory(app.device, stagingMemory, 0, uploadSize, 0, &mapped);
+    for (uint32_t i = 0; i < report.iterations; i++) {
+        uint64_t t0 = timeNowNs();
+        memcpy(mapped, source, uploadSize);
+        uint64_t elapsed = timeNowNs() - t0;
+        samples[i] = elapsed > 0 ? ((double)uploadSize / (1024.0 * 1024.0 * 1024.0)) / ((double)elapsed / 1e9) : 0.0;
+    }
+    vkUnmapMemory(app.device, stagingMemory);
+    bench_AddSamples(&report, "mapped_write_16m", "GiB/s", samples, report.iterations);
+
+    bench_WriteJson(&report);
+
+    free(source);
+    free(samples);
+    vkDestroyBuffer(app.device, staging, NULL);
+    vkFreeMemory(app.device, stagingMemory, NULL);
+    app_Cleanup(&app);
+    return EXIT_SUCCESS;
+}
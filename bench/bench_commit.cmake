@@ -0,0 +1,16 @@
+# Run on every build (see the BenchCommit target in CMakeLists.txt): writes the current commit to OUTPUT as
+# BENCH_GIT_COMMIT. The file is only rewritten when the commit changed, so bench.c isn't recompiled needlessly.
+
+execute_process(
+    COMMAND git rev-parse --short HEAD
+    WORKING_DIRECTORY "${SOURCE_DIR}"
+    OUTPUT_VARIABLE GIT_COMMIT
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET)
+if (NOT GIT_COMMIT)
+    set(GIT_COMMIT "unknown")
+endif()
+
+file(WRITE "${OUTPUT}.tmp" "#pragma once\n#define BENCH_GIT_COMMIT \"${GIT_COMMIT}\"\n")
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different "${OUTPUT}.tmp" "${OUTPUT}")
+file(REMOVE "${OUTPUT}.tmp")
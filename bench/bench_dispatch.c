@@ -0,0 +1,174 @@
+// Per-call cost of device functions through the loader's trampolines (what linking against libvulkan and calling
+// its exported symbols gives) versus the driver entry points from vkGetDeviceProcAddr the engine now calls.
+// Every sample is CALLS_PER_SAMPLE calls of one function; commands are only recorded, never submitted.
+
+#include <app.h>
+#include <bench.h>
+#include <utils.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CALLS_PER_SAMPLE 100000
+
+static double timeSetViewport(VkCommandBuffer commandBuffer, PFN_vkCmdSetViewport pfnSetViewport);
+static double timePushConstants(App *app, VkCommandBuffer commandBuffer, PFN_vkCmdPushConstants pfnPushConstants);
+static double timeSemaphoreCounter(App *app, PFN_vkGetSemaphoreCounterValue pfnGetCounter);
+static void beginRecording(VkCommandBuffer commandBuffer);
+static void endRecording(VkCommandBuffer commandBuffer);
+static double mean(const double *samples, uint32_t count);
+static bool hasActiveLayers(VkPhysicalDevice physicalDevice);
+
+int main(int argc, char **argv) {
+    BenchReport report;
+    if (!bench_Init(&report, "dispatch_overhead", 20, &argc, argv) || argc > 1) {
+        fprintf(stderr, "Usage: %s [--iterations N] [--json PATH]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    bench_SkipIfNoVulkan();
+
+    App app = {0};
+    bench_InitHeadlessApp(&report, &app);
+
+    // A layer intercepts both paths, which would hide the difference being measured. Validation is already off,
+    // but layers can still be injected (VK_INSTANCE_LAYERS, implicit layers such as overlays).
+    if (hasActiveLayers(app.physicalDevice)) {
+        fprintf(stderr, "Vulkan layers are active, skipping.\n");
+        app_Cleanup(&app);
+        return BENCH_SKIP_RETURN_CODE;
+    }
+
+    // Device functions looked up on the instance are the loader's trampolines, which find the driver function
+    // through the dispatch table stored in the handle on every call
+    PFN_vkCmdSetViewport trampolineSetViewport = (PFN_vkCmdSetViewport)vkGetInstanceProcAddr(app.instance, "vkCmdSetViewport");
+    PFN_vkCmdPushConstants trampolinePushConstants = (PFN_vkCmdPushConstants)vkGetInstanceProcAddr(app.instance, "vkCmdPushConstants");
+    PFN_vkGetSemaphoreCounterValue trampolineGetCounter = (PFN_vkGetSemaphoreCounterValue)vkGetInstanceProcAddr(app.instance, "vkGetSemaphoreCounterValue");
+    if (!trampolineSetViewport || !trampolinePushConstants || !trampolineGetCounter) {
+        THROW("Failed to look up loader trampolines");
+    }
+
+    double *samples = (double *)malloc(report.iterations * 6 * sizeof(double));
+    if (!samples) {
+        THROW("malloc fail in bench_dispatch");
+    }
+    double *setViewportTrampoline = samples;
+    double *setViewportDirect = samples + report.iterations;
+    double *pushConstantsTrampoline = samples + report.iterations * 2;
+    double *pushConstantsDirect = samples + report.iterations * 3;
+    double *counterTrampoline = samples + report.iterations * 4;
+    double *counterDirect = samples + report.iterations * 5;
+
+    VkCommandBuffer commandBuffer = app.commandBuffers[0];
+
+    // Interleaved, so clock or thermal drift affects both paths alike
+    for (uint32_t i = 0; i < report.iterations; i++) {
+        setViewportTrampoline[i] = timeSetViewport(commandBuffer, trampolineSetViewport);
+        setViewportDirect[i] = timeSetViewport(commandBuffer, app.dispatch.vkCmdSetViewport);
+        pushConstantsTrampoline[i] = timePushConstants(&app, commandBuffer, trampolinePushConstants);
+        pushConstantsDirect[i] = timePushConstants(&app, commandBuffer, app.dispatch.vkCmdPushConstants);
+        counterTrampoline[i] = timeSemaphoreCounter(&app, trampolineGetCounter);
+        counterDirect[i] = timeSemaphoreCounter(&app, app.dispatch.vkGetSemaphoreCounterValue);
+    }
+
+    bench_AddSamples(&report, "set_viewport_trampoline", "ns/call", setViewportTrampoline, report.iterations);
+    bench_AddSamples(&report, "set_viewport_direct", "ns/call", setViewportDirect, report.iterations);
+    bench_AddSamples(&report, "push_constants_trampoline", "ns/call", pushConstantsTrampoline, report.iterations);
+    bench_AddSamples(&report, "push_constants_direct", "ns/call", pushConstantsDirect, report.iterations);
+    bench_AddSamples(&report, "semaphore_counter_trampoline", "ns/call", counterTrampoline, report.iterations);
+    bench_AddSamples(&report, "semaphore_counter_direct", "ns/call", counterDirect, report.iterations);
+    bench_AddValue(&report, "set_viewport_saving", "ns/call",
+            mean(setViewportTrampoline, report.iterations) - mean(setViewportDirect, report.iterations));
+    bench_AddValue(&report, "push_constants_saving", "ns/call",
+            mean(pushConstantsTrampoline, report.iterations) - mean(pushConstantsDirect, report.iterations));
+    bench_AddValue(&report, "semaphore_counter_saving", "ns/call",
+            mean(counterTrampoline, report.iterations) - mean(counterDirect, report.iterations));
+    bench_WriteJson(&report);
+
+    free(samples);
+    app_Cleanup(&app);
+    return EXIT_SUCCESS;
+}
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+static double timeSetViewport(VkCommandBuffer commandBuffer, PFN_vkCmdSetViewport pfnSetViewport) {
+    VkViewport viewport = {0};
+    viewport.width = (float)WIDTH;
+    viewport.height = (float)HEIGHT;
+    viewport.maxDepth = 1.0f;
+
+    beginRecording(commandBuffer);
+    uint64_t t0 = timeNowNs();
+    for (uint32_t i = 0; i < CALLS_PER_SAMPLE; i++) {
+        pfnSetViewport(commandBuffer, 0, 1, &viewport);
+    }
+    uint64_t elapsed = timeNowNs() - t0;
+    endRecording(commandBuffer);
+
+    return (double)elapsed / CALLS_PER_SAMPLE;
+}
+
+static double timePushConstants(App *app, VkCommandBuffer commandBuffer, PFN_vkCmdPushConstants pfnPushConstants) {
+    PushConstants constants = { { 0.0f, 0.0f }, 1.0f };
+
+    beginRecording(commandBuffer);
+    uint64_t t0 = timeNowNs();
+    for (uint32_t i = 0; i < CALLS_PER_SAMPLE; i++) {
+        pfnPushConstants(commandBuffer, app->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+    }
+    uint64_t elapsed = timeNowNs() - t0;
+    endRecording(commandBuffer);
+
+    return (double)elapsed / CALLS_PER_SAMPLE;
+}
+
+// A non-command function, the kind the frame loop calls every frame
+static double timeSemaphoreCounter(App *app, PFN_vkGetSemaphoreCounterValue pfnGetCounter) {
+    uint64_t value;
+    uint64_t t0 = timeNowNs();
+    for (uint32_t i = 0; i < CALLS_PER_SAMPLE; i++) {
+        pfnGetCounter(app->device, app->frameTimeline, &value);
+    }
+    return (double)(timeNowNs() - t0) / CALLS_PER_SAMPLE;
+}
+
+static void beginRecording(VkCommandBuffer commandBuffer) {
+    VkCommandBufferBeginInfo beginInfo = {0};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkResetCommandBuffer(commandBuffer, 0);
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        THROW("Failed to begin recording command buffer!");
+    }
+}
+
+static void endRecording(VkCommandBuffer commandBuffer) {
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        THROW("Failed to record command buffer!");
+    }
+}
+
+static double mean(const double *samples, uint32_t count) {
+    double sum = 0.0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    return count ? sum / count : 0.0;
+}
+
+// The loader reports the layers active on the instance as the device layers
+static bool hasActiveLayers(VkPhysicalDevice physicalDevice) {
+    uint32_t layerCount = 0;
+    vkEnumerateDeviceLayerProperties(physicalDevice, &layerCount, NULL);
+    if (layerCount == 0)
+        return false;
+
+    VkLayerProperties layers[layerCount];
+    vkEnumerateDeviceLayerProperties(physicalDevice, &layerCount, layers);
+    for (uint32_t i = 0; i < layerCount; i++) {
+        fprintf(stderr, "Active layer: %s\n", layers[i].layerName);
+    }
+
+    return layerCount > 0;
+}
@@ -0,0 +1,66 @@
+// Frame time of the default scene, rendered headless. Every sample is one app_DrawFrame call in steady state,
+// which includes waiting for the frame MAX_FRAMES_IN_FLIGHT frames back to finish on the GPU.
+// With --capture FILE every frame is also read back and streamed to FILE, to check capture doesn't cost frame time.
+
+#include <app.h>
+#include <bench.h>
+#include <readback.h>
+#include <utils.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WARMUP_FRAMES 30
+
+int main(int argc, char **argv) {
+    BenchReport report;
+    bool argsValid = bench_Init(&report, "frame_time", 500, &argc, argv);
+
+    const char *captureFileName = NULL;
+    if (argsValid && argc == 3 && strcmp(argv[1], "--capture") == 0) {
+        captureFileName = argv[2];
+        report.benchmark = "frame_time_capture";
+    } else if (argc > 1) {
+        argsValid = false;
+    }
+
+    if (!argsValid) {
+        fprintf(stderr, "Usage: %s [--iterations FRAMES] [--capture FILE] [--json PATH]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    bench_SkipIfNoVulkan();
+
+    App app = {0};
+    app.captureFileName = captureFileName;
+    bench_InitHeadlessApp(&report, &app);
+
+    double *frameMs = (double *)malloc(report.iterations * sizeof(double));
+    if (!frameMs) {
+        THROW("malloc fail in bench_frame");
+    }
+
+    for (uint32_t i = 0; i < WARMUP_FRAMES; i++) {
+        app_DrawFrame(&app);
+    }
+
+    uint64_t start = timeNowNs();
+    for (uint32_t i = 0; i < report.iterations; i++) {
+        uint64_t t0 = timeNowNs();
+        app_DrawFrame(&app);
+        frameMs[i] = bench_NsToMs(timeNowNs() - t0);
+    }
+    vkDeviceWaitIdle(app.device);
+    double totalSeconds = (double)(timeNowNs() - start) / 1e9;
+
+    bench_AddSamples(&report, "frame_time", "ms", frameMs, report.iterations);
+    bench_AddValue(&report, "fps", "frames/s", report.iterations / totalSeconds);
+    if (app.pReadback) {
+        bench_AddValue(&report, "capture_frames_dropped", "frames", (double)app.pReadback->framesDropped);
+    }
+    bench_WriteJson(&report);
+
+    free(frameMs);
+    app_Cleanup(&app);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,181 @@
+// Mesh loading: parsing an OBJ file versus mapping its binary cache, each with and without the upload into
+// device-local buffers. Uses --obj PATH, or else generates a UV sphere with --segments around its equator.
+// Both files are read from the page cache after the first iteration, so this compares CPU cost, not disk speed.
+
+#include <app.h>
+#include <bench.h>
+#include <mesh.h>
+#include <utils.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DEFAULT_SEGMENTS 1024
+
+static void writeSphereObj(int fd, uint32_t segments);
+static double fileSizeMb(const char *fileName);
+
+int main(int argc, char **argv) {
+    BenchReport report;
+    bool argsValid = bench_Init(&report, "mesh_load", 5, &argc, argv);
+
+    const char *objFileName = NULL;
+    uint32_t segments = DEFAULT_SEGMENTS;
+    for (int i = 1; argsValid && i < argc; i++) {
+        if (strcmp(argv[i], "--obj") == 0 && i + 1 < argc) {
+            objFileName = argv[++i];
+        } else if (strcmp(argv[i], "--segments") == 0 && i + 1 < argc) {
+            segments = (uint32_t)strtoul(argv[++i], NULL, 10);
+            argsValid = segments >= 4;
+        } else {
+            argsValid = false;
+        }
+    }
+
+    if (!argsValid) {
+        fprintf(stderr, "Usage: %s [--iterations N] [--obj PATH | --segments N] [--json PATH]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    bench_SkipIfNoVulkan();
+
+    char generatedObj[] = "/tmp/bench_mesh_obj_XXXXXX";
+    if (!objFileName) {
+        int fd = mkstemp(generatedObj);
+        if (fd < 0) {
+            THROW("Failed to create temporary OBJ file");
+        }
+        writeSphereObj(fd, segments);
+        objFileName = generatedObj;
+    }
+
+    char cacheFileName[] = "/tmp/bench_mesh_cache_XXXXXX";
+    int cacheFd = mkstemp(cacheFileName);
+    if (cacheFd < 0) {
+        THROW("Failed to create temporary mesh cache file");
+    }
+    close(cacheFd);
+
+    MeshData source;
+    mesh_LoadObj(objFileName, &source);
+    meshCache_Write(cacheFileName, &source);
+
+    App app = {0};
+    bench_InitHeadlessApp(&report, &app);
+
+    const double objMb = fileSizeMb(objFileName);
+    const double cacheMb = fileSizeMb(cacheFileName);
+
+    double *samples = (double *)malloc(report.iterations * 6 * sizeof(double));
+    if (!samples) {
+        THROW("malloc fail in bench_mesh");
+    }
+    double *objParseMs = samples;
+    double *objLoadMs = samples + report.iterations;
+    double *objMbPerS = samples + report.iterations * 2;
+    double *cacheOpenMs = samples + report.iterations * 3;
+    double *cacheLoadMs = samples + report.iterations * 4;
+    double *cacheMbPerS = samples + report.iterations * 5;
+
+    for (uint32_t i = 0; i < report.iterations; i++) {
+        MeshData mesh;
+        GpuMesh gpuMesh;
+
+        uint64_t t0 = timeNowNs();
+        mesh_LoadObj(objFileName, &mesh);
+        uint64_t t1 = timeNowNs();
+        mesh_Upload(&app, mesh.pVertices, mesh.vertexCount, mesh.pIndices, mesh.indexCount, &gpuMesh);
+        vkDeviceWaitIdle(app.device); // Upload doesn't wait for the copy, the measurement does
+        uint64_t t2 = timeNowNs();
+        objParseMs[i] = bench_NsToMs(t1 - t0);
+        objLoadMs[i] = bench_NsToMs(t2 - t0);
+        objMbPerS[i] = objMb / (objLoadMs[i] / 1e3);
+        mesh_Destroy(app.device, &gpuMesh);
+        // No frames are drawn to release the staging buffers, but the device is idle
+        deletionQueue_Drain(&app.deletionQueue, app.device, UINT64_MAX, UINT32_MAX);
+        mesh_FreeData(&mesh);
+
+        MeshCache cache;
+        t0 = timeNowNs();
+        if (!meshCache_Open(cacheFileName, &cache)) {
+            THROW("Failed to open the mesh cache just written");
+        }
+        t1 = timeNowNs();
+        mesh_UploadFromCache(&app, &cache, &gpuMesh);
+        vkDeviceWaitIdle(app.device);
+        t2 = timeNowNs();
+        cacheOpenMs[i] = bench_NsToMs(t1 - t0);
+        cacheLoadMs[i] = bench_NsToMs(t2 - t0);
+        cacheMbPerS[i] = cacheMb / (cacheLoadMs[i] / 1e3);
+        mesh_Destroy(app.device, &gpuMesh);
+        deletionQueue_Drain(&app.deletionQueue, app.device, UINT64_MAX, UINT32_MAX);
+        meshCache_Close(&cache);
+    }
+
+    bench_AddValue(&report, "vertices", "count", source.vertexCount);
+    bench_AddValue(&report, "triangles", "count", source.indexCount / 3);
+    bench_AddValue(&report, "obj_file_size", "MB", objMb);
+    bench_AddValue(&report, "cache_file_size", "MB", cacheMb);
+    bench_AddSamples(&report, "obj_parse", "ms", objParseMs, report.iterations);
+    bench_AddSamples(&report, "obj_load_upload", "ms", objLoadMs, report.iterations);
+    bench_AddSamples(&report, "obj_load_throughput", "MB/s", objMbPerS, report.iterations);
+    bench_AddSamples(&report, "cache_open", "ms", cacheOpenMs, report.iterations);
+    bench_AddSamples(&report, "cache_load_upload", "ms", cacheLoadMs, report.iterations);
+    bench_AddSamples(&report, "cache_load_throughput", "MB/s", cacheMbPerS, report.iterations);
+    bench_WriteJson(&report);
+
+    free(samples);
+    mesh_FreeData(&source);
+    app_Cleanup(&app);
+    unlink(cacheFileName);
+    if (objFileName == generatedObj) {
+        unlink(generatedObj);
+    }
+    return EXIT_SUCCESS;
+}
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+// Shared positions, normals and texture coordinates, so every attribute of a face vertex has the same index
+static void writeSphereObj(int fd, uint32_t segments) {
+    FILE *file = fdopen(fd, "w");
+    if (!file) {
+        THROW("Failed to open temporary OBJ file");
+    }
+
+    const uint32_t rings = segments / 2;
+    for (uint32_t r = 0; r <= rings; r++) {
+        float theta = (float)M_PI * (float)r / (float)rings;
+        for (uint32_t s = 0; s <= segments; s++) {
+            float phi = 2.0f * (float)M_PI * (float)s / (float)segments;
+            float x = sinf(theta) * cosf(phi);
+            float y = cosf(theta);
+            float z = sinf(theta) * sinf(phi);
+            fprintf(file, "v %f %f %f\nvn %f %f %f\nvt %f %f\n",
+                    x, y, z, x, y, z, (float)s / (float)segments, 1.0f - (float)r / (float)rings);
+        }
+    }
+
+    for (uint32_t r = 0; r < rings; r++) {
+        for (uint32_t s = 0; s < segments; s++) {
+            uint32_t a = r * (segments + 1) + s + 1;
+            uint32_t b = a + segments + 1;
+            fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, b + 1, b + 1, b + 1, a + 1, a + 1, a + 1);
+        }
+    }
+
+    if (fclose(file) != 0) {
+        THROW("Failed to write temporary OBJ file");
+    }
+}
+
+static double fileSizeMb(const char *fileName) {
+    struct stat fileStat;
+    if (stat(fileName, &fileStat) != 0) {
+        THROW("Failed to stat mesh file");
+    }
+    return (double)fileStat.st_size / (1024.0 * 1024.0);
+}
@@ -0,0 +1,99 @@
+// Graphics pipeline creation with a cold (empty) pipeline cache, a warm (already primed) one, and no cache at all.
+// The shader modules are created once up front, so only vkCreateGraphicsPipelines is timed.
+
+#include <app.h>
+#include <bench.h>
+#include <shaders.h>
+#include <utils.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static VkPipelineCache createEmptyPipelineCache(VkDevice device);
+
+int main(int argc, char **argv) {
+    BenchReport report;
+    if (!bench_Init(&report, "pipeline_creation", 50, &argc, argv) || argc > 1) {
+        fprintf(stderr, "Usage: %s [--iterations N] [--json PATH]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    bench_SkipIfNoVulkan();
+
+    App app = {0};
+    bench_InitHeadlessApp(&report, &app);
+
+    // Swapped in and out below; restored before cleanup
+    VkPipelineCache appCache = app.pipelineCache;
+
+    double *noCacheMs = (double *)malloc(report.iterations * sizeof(double));
+    double *coldMs = (double *)malloc(report.iterations * sizeof(double));
+    double *warmMs = (double *)malloc(report.iterations * sizeof(double));
+    if (!noCacheMs || !coldMs || !warmMs) {
+        THROW("malloc fail in bench_pipeline");
+    }
+
+    size_t vertSize, fragSize;
+    uint32_t *pVert = readShaderSource("shaders/bin/vert.spv", &vertSize);
+    uint32_t *pFrag = readShaderSource("shaders/bin/frag.spv", &fragSize);
+    VkShaderModule vertModule = createShaderModule(app.device, pVert, vertSize);
+    VkShaderModule fragModule = createShaderModule(app.device, pFrag, fragSize);
+
+    VkPipelineCache warmCache = createEmptyPipelineCache(app.device);
+    app.pipelineCache = warmCache;
+    vkDestroyPipeline(app.device, createGraphicsPipelineFromModules(&app, vertModule, fragModule, VK_CULL_MODE_BACK_BIT), NULL);
+
+    for (uint32_t i = 0; i < report.iterations; i++) {
+        app.pipelineCache = VK_NULL_HANDLE;
+        uint64_t t0 = timeNowNs();
+        VkPipeline pipeline = createGraphicsPipelineFromModules(&app, vertModule, fragModule, VK_CULL_MODE_BACK_BIT);
+        noCacheMs[i] = bench_NsToMs(timeNowNs() - t0);
+        vkDestroyPipeline(app.device, pipeline, NULL);
+
+        app.pipelineCache = createEmptyPipelineCache(app.device);
+        t0 = timeNowNs();
+        pipeline = createGraphicsPipelineFromModules(&app, vertModule, fragModule, VK_CULL_MODE_BACK_BIT);
+        coldMs[i] = bench_NsToMs(timeNowNs() - t0);
+        vkDestroyPipeline(app.device, pipeline, NULL);
+        vkDestroyPipelineCache(app.device, app.pipelineCache, NULL);
+
+        app.pipelineCache = warmCache;
+        t0 = timeNowNs();
+        pipeline = createGraphicsPipelineFromModules(&app, vertModule, fragModule, VK_CULL_MODE_BACK_BIT);
+        warmMs[i] = bench_NsToMs(timeNowNs() - t0);
+        vkDestroyPipeline(app.device, pipeline, NULL);
+    }
+
+    size_t cacheSize = 0;
+    vkGetPipelineCacheData(app.device, warmCache, &cacheSize, NULL);
+
+    bench_AddSamples(&report, "create_pipeline_no_cache", "ms", noCacheMs, report.iterations);
+    bench_AddSamples(&report, "create_pipeline_cold_cache", "ms", coldMs, report.iterations);
+    bench_AddSamples(&report, "create_pipeline_warm_cache", "ms", warmMs, report.iterations);
+    bench_AddValue(&report, "pipeline_cache_size", "bytes", (double)cacheSize);
+    bench_WriteJson(&report);
+
+    vkDestroyShaderModule(app.device, vertModule, NULL);
+    vkDestroyShaderModule(app.device, fragModule, NULL);
+    free(pVert);
+    free(pFrag);
+    free(noCacheMs);
+    free(coldMs);
+    free(warmMs);
+    vkDestroyPipelineCache(app.device, warmCache, NULL);
+    app.pipelineCache = appCache;
+    app_Cleanup(&app);
+    return EXIT_SUCCESS;
+}
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+static VkPipelineCache createEmptyPipelineCache(VkDevice device) {
+    VkPipelineCacheCreateInfo cacheInfo = {0};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+    VkPipelineCache cache;
+    if (vkCreatePipelineCache(device, &cacheInfo, NULL, &cache) != VK_SUCCESS) {
+        THROW("Failed to create pipeline cache!");
+    }
+    return cache;
+}
@@ -0,0 +1,59 @@
+// Shader loading: reading the SPIR-V from disk and creating the VkShaderModule, repeated --iterations times.
+
+#include <app.h>
+#include <bench.h>
+#include <shaders.h>
+#include <utils.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv) {
+    BenchReport report;
+    if (!bench_Init(&report, "shader_loading", 200, &argc, argv) || argc > 1) {
+        fprintf(stderr, "Usage: %s [--iterations N] [--json PATH]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    bench_SkipIfNoVulkan();
+
+    App app = {0};
+    bench_InitHeadlessApp(&report, &app);
+
+    double *readMs = (double *)malloc(report.iterations * sizeof(double));
+    double *moduleMs = (double *)malloc(report.iterations * sizeof(double));
+    if (!readMs || !moduleMs) {
+        THROW("malloc fail in bench_shaders");
+    }
+
+    size_t totalBytes = 0;
+    for (uint32_t i = 0; i < report.iterations; i++) {
+        size_t vertSize, fragSize;
+
+        uint64_t t0 = timeNowNs();
+        uint32_t *pVert = readShaderSource("shaders/bin/vert.spv", &vertSize);
+        uint32_t *pFrag = readShaderSource("shaders/bin/frag.spv", &fragSize);
+        uint64_t t1 = timeNowNs();
+        VkShaderModule vertModule = createShaderModule(app.device, pVert, vertSize);
+        VkShaderModule fragModule = createShaderModule(app.device, pFrag, fragSize);
+        uint64_t t2 = timeNowNs();
+
+        readMs[i] = bench_NsToMs(t1 - t0);
+        moduleMs[i] = bench_NsToMs(t2 - t1);
+        totalBytes = vertSize + fragSize;
+
+        vkDestroyShaderModule(app.device, vertModule, NULL);
+        vkDestroyShaderModule(app.device, fragModule, NULL);
+        free(pVert);
+        free(pFrag);
+    }
+
+    bench_AddSamples(&report, "read_spirv", "ms", readMs, report.iterations);
+    bench_AddSamples(&report, "create_shader_modules", "ms", moduleMs, report.iterations);
+    bench_AddValue(&report, "spirv_size", "bytes", (double)totalBytes);
+    bench_WriteJson(&report);
+
+    free(readMs);
+    free(moduleMs);
+    app_Cleanup(&app);
+    return EXIT_SUCCESS;
+}
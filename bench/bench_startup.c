@@ -0,0 +1,58 @@
+// Startup time: headless app_InitVulkan, the first frame after it and app_Cleanup, repeated --iterations times.
+
+#include <app.h>
+#include <bench.h>
+#include <utils.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv) {
+    BenchReport report;
+    if (!bench_Init(&report, "startup", 10, &argc, argv) || argc > 1) {
+        fprintf(stderr, "Usage: %s [--iterations N] [--json PATH]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    bench_SkipIfNoVulkan();
+
+    double *initMs = (double *)malloc(report.iterations * sizeof(double));
+    double *firstFrameMs = (double *)malloc(report.iterations * sizeof(double));
+    double *cleanupMs = (double *)malloc(report.iterations * sizeof(double));
+    if (!initMs || !firstFrameMs || !cleanupMs) {
+        THROW("malloc fail in bench_startup");
+    }
+
+    for (uint32_t i = 0; i < report.iterations; i++) {
+        App app = {0};
+        bench_ConfigureHeadlessApp(&app);
+
+        uint64_t t0 = timeNowNs();
+        app_InitVulkan(&app);
+        uint64_t t1 = timeNowNs();
+        app_DrawFrame(&app);
+        vkDeviceWaitIdle(app.device);
+        uint64_t t2 = timeNowNs();
+
+        if (i == 0) {
+            bench_SetDevice(&report, &app);
+        }
+
+        uint64_t t3 = timeNowNs();
+        app_Cleanup(&app);
+        uint64_t t4 = timeNowNs();
+
+        initMs[i] = bench_NsToMs(t1 - t0);
+        firstFrameMs[i] = bench_NsToMs(t2 - t0);
+        cleanupMs[i] = bench_NsToMs(t4 - t3);
+    }
+
+    bench_AddSamples(&report, "init_vulkan", "ms", initMs, report.iterations);
+    bench_AddSamples(&report, "time_to_first_frame", "ms", firstFrameMs, report.iterations);
+    bench_AddSamples(&report, "cleanup", "ms", cleanupMs, report.iterations);
+    bench_WriteJson(&report);
+
+    free(initMs);
+    free(firstFrameMs);
+    free(cleanupMs);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,197 @@
+// Draw-call submission stress test.
+//
+// Renders headless (no window or surface, so it runs under lavapipe on GPU-less machines) using the regular App
+// device setup, and records a configurable amount of draws, instanced draws, pipeline switches and push constant
+// updates every frame. Reports the CPU recording cost per command and the overall frame rate, as a human readable
+// summary on stderr and as benchmark JSON (see bench.h).
+//
+// Must be run from the repository root so shaders/bin/*.spv can be found.
+
+#include <app.h>
+#include <bench.h>
+#include <utils.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vk_loader.h>
+
+typedef struct StressConfig {
+    uint32_t draws;
+    uint32_t instancedDraws;
+    uint32_t instanceCount;
+    uint32_t pipelineSwitches;
+    uint32_t pushConstantUpdates;
+    uint32_t warmupFrames;
+} StressConfig;
+
+typedef struct StressState {
+    StressConfig config;
+    VkPipeline altPipeline;
+    bool measuring;
+    // Recording time accumulated over the measured frames, per command category
+    uint64_t drawNs;
+    uint64_t instancedDrawNs;
+    uint64_t pipelineSwitchNs;
+    uint64_t pushConstantNs;
+} StressState;
+
+static void printUsage(const char *program);
+static bool parseArgs(int argc, char **argv, StressConfig *config);
+static void recordStressDraws(App *app, VkCommandBuffer commandBuffer, void *pUserData);
+static double nsPerOp(uint64_t totalNs, uint64_t ops);
+
+int main(int argc, char **argv) {
+    StressState state = {0};
+    state.config.draws = 10000;
+    state.config.instancedDraws = 1000;
+    state.config.instanceCount = 16;
+    state.config.pipelineSwitches = 1000;
+    state.config.pushConstantUpdates = 10000;
+    state.config.warmupFrames = 20;
+
+    BenchReport report;
+    if (!bench_Init(&report, "draw_stress", 200, &argc, argv) || !parseArgs(argc, argv, &state.config)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    bench_SkipIfNoVulkan();
+
+    App app = {0};
+    bench_InitHeadlessApp(&report, &app);
+
+    // Same pipeline state apart from culling, so switching between them is a real pipeline bind
+    state.altPipeline = createGraphicsPipeline(&app, VK_CULL_MODE_NONE);
+    app.pfnRecordDraws = recordStressDraws;
+    app.pRecordDrawsUserData = &state;
+
+    for (uint32_t i = 0; i < state.config.warmupFrames; i++) {
+        app_DrawFrame(&app);
+    }
+    vkDeviceWaitIdle(app.device);
+
+    state.measuring = true;
+    uint64_t start = timeNowNs();
+    for (uint32_t i = 0; i < report.iterations; i++) {
+        app_DrawFrame(&app);
+    }
+    vkDeviceWaitIdle(app.device);
+    uint64_t elapsedNs = timeNowNs() - start;
+
+    const StressConfig *c = &state.config;
+    const uint64_t frames = report.iterations;
+    const uint64_t totalDraws = frames * ((uint64_t)c->draws + c->instancedDraws + c->pipelineSwitches + c->pushConstantUpdates);
+    const uint64_t recordNs = state.drawNs + state.instancedDrawNs + state.pipelineSwitchNs + state.pushConstantNs;
+    const double seconds = (double)elapsedNs / 1e9;
+
+    const double fps = seconds > 0.0 ? (double)frames / seconds : 0.0;
+
+    fprintf(stderr, "device:              %s\n", report.deviceName);
+    fprintf(stderr, "frames:              %u (+%u warmup)\n", report.iterations, c->warmupFrames);
+    fprintf(stderr, "per frame:           %u draws, %u instanced draws x%u, %u pipeline switches, %u push constant updates\n",
+            c->draws, c->instancedDraws, c->instanceCount, c->pipelineSwitches, c->pushConstantUpdates);
+    fprintf(stderr, "fps:                 %.2f\n", fps);
+    fprintf(stderr, "frame time:          %.3f ms\n", (double)elapsedNs / 1e6 / (double)frames);
+    fprintf(stderr, "record time:         %.3f ms/frame\n", (double)recordNs / 1e6 / (double)frames);
+    fprintf(stderr, "ns per draw:         %.1f (all draw calls)\n", nsPerOp(recordNs, totalDraws));
+    fprintf(stderr, "  draw:              %.1f ns\n", nsPerOp(state.drawNs, frames * c->draws));
+    fprintf(stderr, "  instanced draw:    %.1f ns\n", nsPerOp(state.instancedDrawNs, frames * c->instancedDraws));
+    fprintf(stderr, "  pipeline switch:   %.1f ns (bind + draw)\n", nsPerOp(state.pipelineSwitchNs, frames * c->pipelineSwitches));
+    fprintf(stderr, "  push constants:    %.1f ns (push + draw)\n", nsPerOp(state.pushConstantNs, frames * c->pushConstantUpdates));
+
+    bench_AddValue(&report, "fps", "frames/s", fps);
+    bench_AddValue(&report, "frame_time", "ms", (double)elapsedNs / 1e6 / (double)frames);
+    bench_AddValue(&report, "record_time", "ms", (double)recordNs / 1e6 / (double)frames);
+    bench_AddValue(&report, "ns_per_draw", "ns", nsPerOp(recordNs, totalDraws));
+    bench_AddValue(&report, "draw", "ns", nsPerOp(state.drawNs, frames * c->draws));
+    bench_AddValue(&report, "instanced_draw", "ns", nsPerOp(state.instancedDrawNs, frames * c->instancedDraws));
+    bench_AddValue(&report, "pipeline_switch", "ns", nsPerOp(state.pipelineSwitchNs, frames * c->pipelineSwitches));
+    bench_AddValue(&report, "push_constants", "ns", nsPerOp(state.pushConstantNs, frames * c->pushConstantUpdates));
+    bench_WriteJson(&report);
+
+    vkDestroyPipeline(app.device, state.altPipeline, NULL);
+    app_Cleanup(&app);
+
+    return EXIT_SUCCESS;
+}
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+static void printUsage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --draws N             plain draws per frame\n"
+            "  --instanced-draws N   instanced draws per frame\n"
+            "  --instances N         instances per instanced draw\n"
+            "  --pipeline-switches N pipeline binds per frame, each followed by a draw\n"
+            "  --push-constants N    push constant updates per frame, each followed by a draw\n"
+            "  --warmup N            unmeasured frames before measuring\n"
+            "  --iterations N        measured frames\n"
+            "  --json PATH           write the results there instead of stdout\n",
+            program);
+}
+
+static bool parseArgs(int argc, char **argv, StressConfig *config) {
+    for (int i = 1; i < argc; i++) {
+        uint32_t *target = NULL;
+        if (strcmp(argv[i], "--draws") == 0) target = &config->draws;
+        else if (strcmp(argv[i], "--instanced-draws") == 0) target = &config->instancedDraws;
+        else if (strcmp(argv[i], "--instances") == 0) target = &config->instanceCount;
+        else if (strcmp(argv[i], "--pipeline-switches") == 0) target = &config->pipelineSwitches;
+        else if (strcmp(argv[i], "--push-constants") == 0) target = &config->pushConstantUpdates;
+        else if (strcmp(argv[i], "--warmup") == 0) target = &config->warmupFrames;
+        else return false;
+
+        if (i + 1 >= argc)
+            return false;
+        *target = (uint32_t)strtoul(argv[++i], NULL, 10);
+    }
+
+    return true;
+}
+
+static void recordStressDraws(App *app, VkCommandBuffer commandBuffer, void *pUserData) {
+    StressState *state = (StressState *)pUserData;
+    const StressConfig *c = &state->config;
+
+    // Small triangles spread over a grid, so rasterization stays cheap and the CPU side dominates
+    PushConstants pushConstants = { .offset = { 0.0f, 0.0f }, .scale = 0.05f };
+    vkCmdPushConstants(commandBuffer, app->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &pushConstants);
+
+    uint64_t t0 = timeNowNs();
+    for (uint32_t i = 0; i < c->draws; i++) {
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    }
+
+    uint64_t t1 = timeNowNs();
+    for (uint32_t i = 0; i < c->instancedDraws; i++) {
+        vkCmdDraw(commandBuffer, 3, c->instanceCount, 0, 0);
+    }
+
+    uint64_t t2 = timeNowNs();
+    for (uint32_t i = 0; i < c->pipelineSwitches; i++) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, (i & 1) ? app->graphicsPipeline : state->altPipeline);
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    }
+
+    uint64_t t3 = timeNowNs();
+    for (uint32_t i = 0; i < c->pushConstantUpdates; i++) {
+        pushConstants.offset[0] = (float)(i % 32) / 16.0f - 1.0f;
+        pushConstants.offset[1] = (float)((i / 32) % 32) / 16.0f - 1.0f;
+        vkCmdPushConstants(commandBuffer, app->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &pushConstants);
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    }
+    uint64_t t4 = timeNowNs();
+
+    if (state->measuring) {
+        state->drawNs += t1 - t0;
+        state->instancedDrawNs += t2 - t1;
+        state->pipelineSwitchNs += t3 - t2;
+        state->pushConstantNs += t4 - t3;
+    }
+}
+
+static double nsPerOp(uint64_t totalNs, uint64_t ops) {
+    return ops > 0 ? (double)totalNs / (double)ops : 0.0;
+}
@@ -3,23 +3,99 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
-typedef struct App {
+#include <deletion_queue.h>
+#include <vk_loader.h>
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#define MAX_FRAMES_IN_FLIGHT 2
+
+// The instance and device API versions are negotiated down from the newest version this code knows how to use
+#define APP_MIN_API_VERSION VK_API_VERSION_1_2
+#define APP_MAX_API_VERSION VK_API_VERSION_1_3
+
+extern const uint32_t WIDTH;
+extern const uint32_t HEIGHT;
+
+// Must match the push_constant block in shaders/shader.vert
+typedef struct PushConstants {
+    float offset[2];
+    float scale;
+} PushConstants;
+
+// What app_PickPhysicalDevice negotiated, and app_CreateLogicalDevice enabled
+typedef struct DeviceFeatures {
+    uint32_t apiVersion; // min(instance version, device version)
+    bool timelineSemaphore; // Required
+    bool bufferDeviceAddress;
+    bool descriptorIndexing;
+    bool synchronization2;
+    bool presentWait; // VK_KHR_present_id + VK_KHR_present_wait, never set when headless
+} DeviceFeatures;
+
+typedef struct App App;
+struct Readback;
+struct FramePacer;
+struct Simulation;
+
+// Records the draws of one frame. Called inside the render pass with the graphics pipeline, viewport and scissor already bound.
+typedef void (*PFN_appRecordDraws)(App *app, VkCommandBuffer commandBuffer, void *pUserData);
+
+struct App {
     GLFWwindow *window;
+    bool headless; // No window or surface: render into offscreen images instead of a swap chain
+    bool disableValidation; // Set before app_InitVulkan to run without validation layers even where they are installed
+    bool validationEnabled;
     VkInstance instance;
+    uint32_t apiVersion;
     VkDebugUtilsMessengerEXT debugMessenger;
     VkSurfaceKHR surface;
     VkPhysicalDevice physicalDevice;
+    DeviceFeatures deviceFeatures;
     VkDevice device;
+    DeviceDispatch dispatch; // Entry points of device, the global vk* device functions point at the same ones
     VkQueue graphicsQueue;
     VkQueue presentQueue;
     VkSwapchainKHR swapChain;
+    bool framebufferResized; // The swap chain is recreated after the next present
     VkImage *pSwapChainImages;
+    VkDeviceMemory *pOffscreenImageMemory; // Only used when headless
     uint32_t swapChainImageCount;
     VkFormat swapChainImageFormat;
     VkExtent2D swapChainExtent;
     VkImageView *pSwapChainImageViews;
+    VkFramebuffer *pSwapChainFramebuffers;
+    VkRenderPass renderPass;
     VkPipelineLayout pipelineLayout;
-} App;
+    VkPipelineCache pipelineCache;
+    VkPipeline graphicsPipeline;
+    VkCommandPool commandPool;
+    VkCommandBuffer commandBuffers[MAX_FRAMES_IN_FLIGHT];
+    VkSemaphore imageAvailableSemaphores[MAX_FRAMES_IN_FLIGHT];
+    VkSemaphore *pRenderFinishedSemaphores; // One per swap chain image
+    // Frame N signals N + 1 when it completes, so the counter value is the number of completed frames.
+    // This is the only CPU/GPU (and cross-queue) synchronization primitive; binary semaphores are only
+    // used where the swap chain requires them.
+    VkSemaphore frameTimeline;
+    uint32_t currentFrame;
+    uint64_t frameCount; // Frames submitted so far
+    DeletionQueue deletionQueue; // See app_DeferDestroy
+    PFN_appRecordDraws pfnRecordDraws; // Optional, draws the default triangle when NULL
+    void *pRecordDrawsUserData;
+    const char *captureFileName; // When set before app_InitVulkan, every frame is streamed to this file
+    struct Readback *pReadback;
+    bool lowLatency; // Trade throughput for input-to-photon latency, see frame_pacer.h
+    struct FramePacer *pFramePacer; // Only when presenting to a window
+    // On-demand rendering: app_MainLoop sleeps in glfwWaitEvents and only draws a frame when the scene is dirty.
+    // Window input marks it dirty, app_MarkDirty covers everything else (streamed data, other threads).
+    bool onDemand;
+    bool animating; // Draw continuously even in on-demand mode, see app_SetAnimating
+    atomic_bool sceneDirty;
+    uint64_t idleWakeups; // Times app_MainLoop woke up from an idle wait
+    uint32_t simulationHz; // When set before app_InitVulkan, the default scene is animated by a simulation thread at this tick rate
+    struct Simulation *pSimulation;
+};
 
 typedef enum APP_Result {
     APP_ERROR,
@@ -30,7 +106,27 @@ void app_Run(App *app, APP_Result *result);
 void app_InitWindow(App *app);
 void app_InitVulkan(App *app);
 void app_CreateSwapChain(App *app);
+void app_RecreateSwapChain(App *app); // Keeps the old swap chain if the window is closed while minimized
 void app_CreateImageViews(App *app);
+void app_CreateRenderPass(App *app);
+void app_CreatePipelineCache(App *app);
 void app_CreateGraphicsPipeline(App *app);
+void app_CreateFramebuffers(App *app);
+void app_CreateCommandPool(App *app);
+void app_CreateCommandBuffers(App *app);
+void app_CreateSyncObjects(App *app);
+void app_CreateRenderFinishedSemaphores(App *app);
+void app_RecordCommandBuffer(App *app, VkCommandBuffer commandBuffer, uint32_t imageIndex);
+void app_DrawFrame(App *app);
+uint64_t app_GetCompletedFrameCount(App *app);
+void app_WaitForCompletedFrames(App *app, uint64_t completedFrames);
+// Destroys the resource once every frame submitted so far has completed, without stalling
+void app_DeferDestroy(App *app, DeferredResourceType type, DeferredHandle handle);
 void app_MainLoop(App *app);
+void app_MarkDirty(App *app); // Thread-safe, wakes app_MainLoop up
+void app_SetAnimating(App *app, bool animating);
 void app_Cleanup(App *app);
+
+VkPipeline createGraphicsPipeline(App *app, VkCullModeFlags cullMode);
+// Same, with shader modules the caller already created (and still owns)
+VkPipeline createGraphicsPipelineFromModules(App *app, VkShaderModule vertShaderModule, VkShaderModule fragShaderModule, VkCullModeFlags cullMode);
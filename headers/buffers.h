@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+#include <utils.h>
+#include <vk_loader.h>
+
+// Like findMemoryType, but lets the caller fall back to other properties instead of failing
+OptionalUint32 queryMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
+
+uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
+
+void createBuffer(
+        VkPhysicalDevice physicalDevice,
+        VkDevice device,
+        VkDeviceSize size,
+        VkBufferUsageFlags usage,
+        VkMemoryPropertyFlags properties,
+        VkBuffer *pBuffer,
+        VkDeviceMemory *pBufferMemory);
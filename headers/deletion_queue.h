@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <vk_loader.h>
+
+// At most this many resources are destroyed per deletionQueue_Drain call, so a burst of releases (e.g. a level
+// unload) is spread over a few frames instead of lengthening one
+#define DELETION_QUEUE_MAX_PER_DRAIN 32
+
+typedef enum DeferredResourceType {
+    DEFERRED_BUFFER,
+    DEFERRED_IMAGE,
+    DEFERRED_IMAGE_VIEW,
+    DEFERRED_MEMORY,
+    DEFERRED_FRAMEBUFFER,
+    DEFERRED_PIPELINE,
+    DEFERRED_SEMAPHORE,
+    DEFERRED_SWAPCHAIN,
+    DEFERRED_COMMAND_BUFFER,
+} DeferredResourceType;
+
+typedef union DeferredHandle {
+    VkBuffer buffer;
+    VkImage image;
+    VkImageView imageView;
+    VkDeviceMemory memory;
+    VkFramebuffer framebuffer;
+    VkPipeline pipeline;
+    VkSemaphore semaphore;
+    VkSwapchainKHR swapChain;
+    struct {
+        VkCommandPool pool;
+        VkCommandBuffer buffer;
+    } commandBuffer;
+} DeferredHandle;
+
+typedef struct DeferredDestroy {
+    DeferredResourceType type;
+    DeferredHandle handle;
+    uint64_t releaseFrame; // Destroyed once this many frames have completed (frame timeline value)
+} DeferredDestroy;
+
+// Resources the GPU may still be using, destroyed once the frame timeline shows it's done with them instead of
+// after a vkDeviceWaitIdle. Entries are released in push order: one is never destroyed before those pushed ahead
+// of it, which at worst delays it by a frame or two.
+typedef struct DeletionQueue {
+    DeferredDestroy *pEntries; // Ring buffer, grown on demand
+    uint32_t head;
+    uint32_t count;
+    uint32_t capacity;
+    uint64_t released; // Destroyed by deletionQueue_Drain so far
+} DeletionQueue;
+
+void deletionQueue_Push(DeletionQueue *queue, DeferredResourceType type, DeferredHandle handle, uint64_t releaseFrame);
+
+// Destroys up to maxCount resources whose release frame has completed
+void deletionQueue_Drain(DeletionQueue *queue, VkDevice device, uint64_t completedFrames, uint32_t maxCount);
+
+// Expects the device to be idle: destroys everything left and frees the queue
+void deletionQueue_Flush(DeletionQueue *queue, VkDevice device);
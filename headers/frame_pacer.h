@@ -0,0 +1,73 @@
+#pragma once
+
+#include <app.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Number of recent frames the latency statistics are computed over
+#define FRAME_PACER_HISTORY 128
+
+// Wake up this long before the frame is predicted to be needed, to absorb scheduling jitter
+#define FRAME_PACER_MARGIN_NS 1000000ull
+
+typedef struct FrameTiming {
+    uint64_t inputSampleNs;
+    uint64_t submitNs;
+    bool gpuTimestampsWritten;
+} FrameTiming;
+
+typedef struct LatencyStats {
+    uint64_t frames;
+    uint32_t historyFrames;     // Frames the average and max are over, at most FRAME_PACER_HISTORY
+    double inputToPresentAvgMs;
+    double inputToPresentMaxMs;
+    double cpuMs;               // Input sample to submit, moving average
+    double gpuMs;               // From GPU timestamps, 0 when unsupported
+    double sleepAvgMs;          // Time spent delaying input sampling, per frame
+    bool presentWait;           // Whether latency is measured to the actual present (low latency mode with present wait), or to GPU completion
+} LatencyStats;
+
+// Latency-aware frame scheduling. Measures input-sample-to-present latency and, in low latency mode, delays
+// input sampling and CPU work until just before they're needed:
+//   1. wait until the previous frame was presented (VK_KHR_present_wait) or completed (frame timeline), so at most
+//      one frame is ever queued ahead of the display;
+//   2. sleep for the part of the present interval the next frame is predicted not to need (CPU + GPU time).
+// Input sampled right after framePacer_WaitForNextFrame is then as fresh as possible when the frame reaches the screen.
+typedef struct FramePacer {
+    bool lowLatency;
+    bool presentWait;
+    VkQueryPool timestampPool; // Two timestamps per frame slot, VK_NULL_HANDLE when unsupported
+    double timestampPeriodNs;
+
+    FrameTiming frames[MAX_FRAMES_IN_FLIGHT];
+    uint64_t lastPresentNs;
+    double cpuEmaNs;
+    double gpuEmaNs;
+    double presentIntervalEmaNs;
+
+    double latencyHistoryNs[FRAME_PACER_HISTORY];
+    uint32_t latencyHistoryNext;
+    uint64_t latencySamples;
+    double sleepTotalNs;
+    uint64_t framesPaced;
+    uint64_t settledFrameCount; // app->frameCount when framePacer_SettleIdle last ran
+} FramePacer;
+
+FramePacer *framePacer_Create(App *app, bool lowLatency);
+void framePacer_Destroy(FramePacer *pacer, VkDevice device);
+
+// Call before sampling input for the next frame
+void framePacer_WaitForNextFrame(FramePacer *pacer, App *app);
+void framePacer_MarkInputSampled(FramePacer *pacer, App *app);
+
+// Call before the app stops rendering for a while (on-demand mode) or recreates the swap chain: measures the last
+// frame now rather than when the next one starts, so the gap doesn't end up in the latency and present interval statistics
+void framePacer_SettleIdle(FramePacer *pacer, App *app);
+
+// Called by app_RecordCommandBuffer and app_DrawFrame
+void framePacer_RecordFrameStart(FramePacer *pacer, App *app, VkCommandBuffer commandBuffer);
+void framePacer_RecordFrameEnd(FramePacer *pacer, App *app, VkCommandBuffer commandBuffer);
+void framePacer_MarkSubmitted(FramePacer *pacer, App *app);
+
+LatencyStats framePacer_GetStats(const FramePacer *pacer);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <app.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Mesh cache files start with "VKMC". Files from another version are rejected by meshCache_Open and have to be
+// regenerated from the source mesh (MeshConvert), nothing rewrites them automatically.
+#define MESH_CACHE_MAGIC 0x434d4b56u
+#define MESH_CACHE_VERSION 1
+
+// Blob offsets in cache files are aligned to this, which covers every buffer offset alignment the spec allows
+// (and nonCoherentAtomSize), so a blob can be copied or mapped as is
+#define MESH_CACHE_ALIGNMENT 256
+
+typedef struct Vertex {
+    float position[3];
+    float normal[3];
+    float uv[2];
+} Vertex;
+
+// A mesh in host memory, as parsed from a source format
+typedef struct MeshData {
+    Vertex *pVertices;
+    uint32_t vertexCount;
+    uint32_t *pIndices; // Triangle list
+    uint32_t indexCount;
+} MeshData;
+
+// On-disk layout of a mesh cache: this header, then the vertex blob (Vertex[vertexCount]) and the index blob
+// (uint32_t[indexCount]), both at MESH_CACHE_ALIGNMENT aligned offsets. Stored in host byte order.
+typedef struct MeshCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexStride; // sizeof(Vertex)
+    uint32_t indexSize;    // Bytes per index, always 4
+    uint64_t vertexCount;
+    uint64_t vertexOffset;
+    uint64_t indexCount;
+    uint64_t indexOffset;
+    float boundsMin[3];
+    float boundsMax[3];
+} MeshCacheHeader;
+
+// A mesh cache file mapped read-only. The blobs point into the mapping, nothing is parsed or copied; the indices
+// are only read once, to check they are in range.
+typedef struct MeshCache {
+    void *pMapped;
+    size_t size;
+    const MeshCacheHeader *pHeader;
+    const Vertex *pVertices;
+    const uint32_t *pIndices;
+} MeshCache;
+
+// Device-local vertex and index buffers
+typedef struct GpuMesh {
+    VkBuffer vertexBuffer;
+    VkDeviceMemory vertexMemory;
+    VkBuffer indexBuffer;
+    VkDeviceMemory indexMemory;
+    uint32_t indexCount;
+} GpuMesh;
+
+// Parses a Wavefront OBJ file (positions, normals and texture coordinates; polygons are triangulated as fans) and
+// deduplicates its vertices
+void mesh_LoadObj(const char *fileName, MeshData *mesh);
+void mesh_FreeData(MeshData *mesh);
+
+void meshCache_Write(const char *fileName, const MeshData *mesh);
+
+// Returns false if the file is missing, from another version or malformed (including an empty mesh or an index
+// past the last vertex), in which case it should be regenerated
+bool meshCache_Open(const char *fileName, MeshCache *cache);
+void meshCache_Close(MeshCache *cache);
+
+// Copies the mesh into device-local buffers through a staging buffer without waiting for the copy: frames submitted
+// afterwards can draw it right away, and the staging buffer is released through the deletion queue. The GpuMesh
+// must not be destroyed before the copy completed (e.g. after vkDeviceWaitIdle, or through app_DeferDestroy).
+void mesh_Upload(App *app, const Vertex *pVertices, uint32_t vertexCount, const uint32_t *pIndices, uint32_t indexCount, GpuMesh *gpuMesh);
+void mesh_UploadFromCache(App *app, const MeshCache *cache, GpuMesh *gpuMesh);
+void mesh_Destroy(VkDevice device, GpuMesh *gpuMesh);
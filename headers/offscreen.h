@@ -0,0 +1,11 @@
+#pragma once
+
+#include <app.h>
+
+#define OFFSCREEN_IMAGE_COUNT 3
+#define OFFSCREEN_IMAGE_FORMAT VK_FORMAT_B8G8R8A8_UNORM
+
+// Stands in for app_CreateSwapChain when running headless: the images are exposed through the same
+// pSwapChainImages/swapChainImageFormat/swapChainExtent fields so the rest of the renderer is unchanged.
+void app_CreateOffscreenTargets(App *app);
+void app_DestroyOffscreenTargets(App *app);
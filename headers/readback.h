@@ -0,0 +1,65 @@
+#pragma once
+
+#include <app.h>
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// More slots than frames in flight, so the writer thread can lag a few frames behind before frames get dropped
+#define READBACK_SLOT_COUNT (MAX_FRAMES_IN_FLIGHT + 4)
+
+typedef enum ReadbackSlotState {
+    READBACK_SLOT_FREE,
+    READBACK_SLOT_IN_FLIGHT, // Copy recorded, GPU may still be writing
+    READBACK_SLOT_QUEUED,    // GPU done, waiting for (or being written by) the writer thread
+} ReadbackSlotState;
+
+typedef struct ReadbackSlot {
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+    void *pMapped; // Persistently mapped, only read once the frame that filled it has completed
+    uint64_t frameNumber;
+    ReadbackSlotState state;
+} ReadbackSlot;
+
+// Streams rendered frames to a file as raw pixels in the swap chain format, without stalling the frame loop:
+// each frame is copied into a host-cached staging buffer, which is only handed to the writer thread once the
+// frame timeline shows the frame completed, typically MAX_FRAMES_IN_FLIGHT frames later.
+typedef struct Readback {
+    ReadbackSlot slots[READBACK_SLOT_COUNT];
+    uint32_t nextCopySlot;
+    uint32_t nextCollectSlot;
+    VkExtent2D extent;      // Every frame in the file has this size
+    VkDeviceSize frameSize;
+    bool hostCoherent;
+
+    FILE *file;
+    pthread_t writerThread;
+    pthread_mutex_t mutex; // Guards slot states, the writer queue and the stats
+    pthread_cond_t wake;
+    uint32_t queue[READBACK_SLOT_COUNT];
+    uint32_t queueHead;
+    uint32_t queueCount;
+    bool stopping;
+    bool writeFailed; // Set by the writer thread on a short write, which stops the capture
+
+    uint64_t framesCaptured; // Written to the file in full
+    uint64_t framesDropped;
+    uint64_t bytesWritten;
+} Readback;
+
+// Returns NULL, and clears app->captureFileName, when the swap chain format isn't 4 bytes per pixel
+Readback *readback_Create(App *app, const char *fileName);
+
+// Records the copy of the swap chain image into the next free slot. Must be called after the render pass ended.
+// The frame is dropped (and counted) if every slot is still busy, or if the swap chain was recreated at a size
+// other than the one capture started with, since the file is a plain sequence of equally sized frames.
+// Does nothing once a write failed.
+void readback_RecordCopy(Readback *readback, App *app, VkCommandBuffer commandBuffer, uint32_t imageIndex, uint64_t frameNumber);
+
+// Hands every slot filled by a frame numbered below completedFrames (see app_GetCompletedFrameCount) over to the writer thread
+void readback_Collect(Readback *readback, VkDevice device, uint64_t completedFrames);
+
+// Expects the device to be idle: flushes every pending frame, joins the writer thread and frees the ring
+void readback_Destroy(Readback *readback, VkDevice device);
@@ -2,7 +2,7 @@
 
 #include <app.h>
 #include <stddef.h>
-#include <vulkan/vulkan_core.h>
+#include <vk_loader.h>
 
 uint32_t *readShaderSource(char *fileName, size_t *outSize);
 
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <app.h>
+
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define SIMULATION_OBJECT_COUNT 16
+
+// Tick rates above this leave no time to sleep between ticks
+#define SIMULATION_MAX_HZ 10000
+
+// A simulation thread more than this many ticks behind schedule (e.g. after the process was suspended) skips
+// ahead instead of running them all back to back
+#define SIMULATION_MAX_CATCHUP_TICKS 5
+
+// Everything the renderer needs from one simulation step. The step before it travels along, so the renderer can
+// interpolate from a single snapshot however many snapshots it missed in between.
+typedef struct SceneSnapshot {
+    uint64_t tick;
+    uint64_t simTimeNs; // Time this state corresponds to, on the timeNowNs clock
+    uint64_t previousSimTimeNs;
+    PushConstants transforms[SIMULATION_OBJECT_COUNT];
+    PushConstants previousTransforms[SIMULATION_OBJECT_COUNT];
+} SceneSnapshot;
+
+// Simulation state, only touched by the simulation thread
+typedef struct SimulationObject {
+    float angle;
+    float angularVelocity; // Radians per second
+    float radius;
+    float scale;
+} SimulationObject;
+
+// Steps the scene at a fixed rate on its own thread. Snapshots reach the render thread through a lock-free triple
+// buffer: the simulation thread fills its back slot and swaps it with the shared middle slot, the render thread
+// swaps the middle slot with its front slot whenever a fresh one is there. Neither thread ever waits on the other,
+// and the renderer interpolates between the two latest snapshots so motion stays smooth at any frame rate.
+typedef struct Simulation {
+    App *app;
+    uint32_t tickHz;
+    uint64_t tickNs;
+    uint64_t startNs; // Tick N is the state at startNs + N * tickNs
+    pthread_t thread;
+    atomic_bool stopping;
+
+    SceneSnapshot slots[3];
+    alignas(64) atomic_uint middle; // Slot index, plus a fresh bit until the render thread takes it
+    alignas(64) uint32_t back;      // Simulation thread only
+    SimulationObject objects[SIMULATION_OBJECT_COUNT];
+    uint64_t lastSimTimeNs; // The last step written, carried into the next snapshot
+    PushConstants lastTransforms[SIMULATION_OBJECT_COUNT];
+    uint64_t ticks;
+    uint64_t skippedTicks;
+    uint64_t stepTotalNs;
+
+    alignas(64) uint32_t front;     // Render thread only
+} Simulation;
+
+// tickHz must be between 1 and SIMULATION_MAX_HZ
+Simulation *simulation_Create(App *app, uint32_t tickHz);
+void simulation_Destroy(Simulation *simulation);
+
+// Render thread: picks up the newest snapshot if there is one, and writes the transforms interpolated between its
+// step and the one before at nowNs minus one tick (so there's a step on each side of it)
+void simulation_Interpolate(Simulation *simulation, uint64_t nowNs, PushConstants transforms[SIMULATION_OBJECT_COUNT]);
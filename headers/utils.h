@@ -11,3 +11,9 @@ typedef struct OptionalUint32 {
 } OptionalUint32;
 
 uint32_t clamp(uint32_t value, uint32_t min, uint32_t max);
+
+// Monotonic clock, for frame timing and benchmarks
+uint64_t timeNowNs(void);
+
+// CPU time consumed by every thread of the process
+uint64_t cpuTimeNs(void);
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
-#include <vulkan/vulkan_core.h>
+#include <vk_loader.h>
 
 extern const bool enableValidationLayers;
 
@@ -9,6 +9,8 @@ extern const bool enableValidationLayers;
 
 const char **getValidationLayers();
 
+bool checkValidationLayerSupport();
+
 void vkDebugMessengerCreateInfo_Populate(VkDebugUtilsMessengerCreateInfoEXT *pCreateInfo);
 
 VkResult vkDebugUtilsMessengerEXT_Create(
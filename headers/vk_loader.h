@@ -0,0 +1,128 @@
+#pragma once
+
+// Vulkan is compiled with VK_NO_PROTOTYPES (see CMakeLists.txt) and nothing links against libvulkan: every vk*
+// function used in the tree is a function pointer declared here, under the usual name, filled in at runtime.
+//   - vkLoader_Init dlopens the loader and resolves the global functions;
+//   - vkLoader_LoadInstance resolves instance functions, and device functions as loader trampolines;
+//   - vkLoader_LoadDevice points the device functions straight at the driver through vkGetDeviceProcAddr, which
+//     skips the loader's per-call dispatch on the hot path (command recording, submit, present).
+// The global device functions belong to one device at a time: vkLoader_LoadDevice refuses a second device while
+// one is loaded, and vkLoader_UnloadDevice (once the device is destroyed) puts the trampolines back. Code that
+// needs several live devices has to call through their own DeviceDispatch tables instead.
+// Any function not listed below has to be added to the matching list before it can be called.
+
+#include <stdbool.h>
+#include <vulkan/vulkan_core.h>
+
+#define VK_LOADER_GLOBAL_FUNCTIONS(X) \
+    X(vkCreateInstance) \
+    X(vkEnumerateInstanceVersion) \
+    X(vkEnumerateInstanceLayerProperties)
+
+#define VK_LOADER_INSTANCE_FUNCTIONS(X) \
+    X(vkDestroyInstance) \
+    X(vkEnumeratePhysicalDevices) \
+    X(vkGetPhysicalDeviceProperties) \
+    X(vkGetPhysicalDeviceFeatures2) \
+    X(vkGetPhysicalDeviceMemoryProperties) \
+    X(vkGetPhysicalDeviceQueueFamilyProperties) \
+    X(vkEnumerateDeviceExtensionProperties) \
+    X(vkEnumerateDeviceLayerProperties) \
+    X(vkCreateDevice) \
+    X(vkGetDeviceProcAddr) \
+    X(vkDestroySurfaceKHR) \
+    X(vkGetPhysicalDeviceSurfaceSupportKHR) \
+    X(vkGetPhysicalDeviceSurfaceCapabilitiesKHR) \
+    X(vkGetPhysicalDeviceSurfaceFormatsKHR) \
+    X(vkGetPhysicalDeviceSurfacePresentModesKHR)
+
+#define VK_LOADER_DEVICE_FUNCTIONS(X) \
+    X(vkDestroyDevice) \
+    X(vkDeviceWaitIdle) \
+    X(vkGetDeviceQueue) \
+    X(vkQueueSubmit) \
+    X(vkQueueWaitIdle) \
+    X(vkAllocateMemory) \
+    X(vkFreeMemory) \
+    X(vkMapMemory) \
+    X(vkUnmapMemory) \
+    X(vkInvalidateMappedMemoryRanges) \
+    X(vkCreateBuffer) \
+    X(vkDestroyBuffer) \
+    X(vkGetBufferMemoryRequirements) \
+    X(vkBindBufferMemory) \
+    X(vkCreateImage) \
+    X(vkDestroyImage) \
+    X(vkGetImageMemoryRequirements) \
+    X(vkBindImageMemory) \
+    X(vkCreateImageView) \
+    X(vkDestroyImageView) \
+    X(vkCreateFramebuffer) \
+    X(vkDestroyFramebuffer) \
+    X(vkCreateRenderPass) \
+    X(vkDestroyRenderPass) \
+    X(vkCreateShaderModule) \
+    X(vkDestroyShaderModule) \
+    X(vkCreatePipelineCache) \
+    X(vkDestroyPipelineCache) \
+    X(vkGetPipelineCacheData) \
+    X(vkCreatePipelineLayout) \
+    X(vkDestroyPipelineLayout) \
+    X(vkCreateGraphicsPipelines) \
+    X(vkDestroyPipeline) \
+    X(vkCreateCommandPool) \
+    X(vkDestroyCommandPool) \
+    X(vkAllocateCommandBuffers) \
+    X(vkFreeCommandBuffers) \
+    X(vkResetCommandBuffer) \
+    X(vkBeginCommandBuffer) \
+    X(vkEndCommandBuffer) \
+    X(vkCreateSemaphore) \
+    X(vkDestroySemaphore) \
+    X(vkGetSemaphoreCounterValue) \
+    X(vkWaitSemaphores) \
+    X(vkCreateQueryPool) \
+    X(vkDestroyQueryPool) \
+    X(vkGetQueryPoolResults) \
+    X(vkCmdBeginRenderPass) \
+    X(vkCmdEndRenderPass) \
+    X(vkCmdBindPipeline) \
+    X(vkCmdSetViewport) \
+    X(vkCmdSetScissor) \
+    X(vkCmdPushConstants) \
+    X(vkCmdDraw) \
+    X(vkCmdPipelineBarrier) \
+    X(vkCmdCopyBuffer) \
+    X(vkCmdCopyImageToBuffer) \
+    X(vkCmdResetQueryPool) \
+    X(vkCmdWriteTimestamp) \
+    X(vkCreateSwapchainKHR) \
+    X(vkDestroySwapchainKHR) \
+    X(vkGetSwapchainImagesKHR) \
+    X(vkAcquireNextImageKHR) \
+    X(vkQueuePresentKHR) \
+    X(vkWaitForPresentKHR)
+
+#define VK_LOADER_DECLARE_FUNCTION(name) extern PFN_##name name;
+extern PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
+VK_LOADER_GLOBAL_FUNCTIONS(VK_LOADER_DECLARE_FUNCTION)
+VK_LOADER_INSTANCE_FUNCTIONS(VK_LOADER_DECLARE_FUNCTION)
+VK_LOADER_DEVICE_FUNCTIONS(VK_LOADER_DECLARE_FUNCTION)
+#undef VK_LOADER_DECLARE_FUNCTION
+
+// The device functions of one device, as returned by vkGetDeviceProcAddr. Functions of extensions the device
+// doesn't have enabled (e.g. swap chain ones when headless) are NULL.
+typedef struct DeviceDispatch {
+#define VK_LOADER_DISPATCH_MEMBER(name) PFN_##name name;
+    VK_LOADER_DEVICE_FUNCTIONS(VK_LOADER_DISPATCH_MEMBER)
+#undef VK_LOADER_DISPATCH_MEMBER
+} DeviceDispatch;
+
+// Returns false when no Vulkan loader is installed. Safe to call more than once.
+bool vkLoader_Init(void);
+void vkLoader_LoadInstance(VkInstance instance);
+void vkLoader_LoadDeviceDispatch(VkDevice device, DeviceDispatch *dispatch);
+// Fills dispatch, and points the global device functions at it. Returns false, leaving everything untouched, when
+// another device is still loaded.
+bool vkLoader_LoadDevice(VkDevice device, DeviceDispatch *dispatch);
+void vkLoader_UnloadDevice(VkDevice device);
@@ -12,9 +12,14 @@ vec3 colors[3] = vec3[](
     vec3(0.0, 0.0, 1.0)
 );
 
+layout(push_constant) uniform PushConstants {
+    vec2 offset;
+    float scale;
+} pc;
+
 layout(location = 0) out vec3 fragColor;
 
 void main() {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
+    gl_Position = vec4(positions[gl_VertexIndex] * pc.scale + pc.offset, 0.0, 1.0);
     fragColor = colors[gl_VertexIndex];
 }
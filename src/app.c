@@ -1,5 +1,9 @@
 #include <app.h>
+#include <frame_pacer.h>
+#include <offscreen.h>
+#include <readback.h>
 #include <shaders.h>
+#include <simulation.h>
 #include <swapchain.h>
 #include <validation_layers.h>
 #include <vk_instance.h>
@@ -7,11 +11,20 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <vulkan/vulkan_core.h>
+#include <utils.h>
+#include <vk_loader.h>
 
 const uint32_t WIDTH = 800;
 const uint32_t HEIGHT = 600;
 
+static void onKey(GLFWwindow *window, int key, int scancode, int action, int mods);
+static void onCursorPos(GLFWwindow *window, double x, double y);
+static void onMouseButton(GLFWwindow *window, int button, int action, int mods);
+static void onScroll(GLFWwindow *window, double dx, double dy);
+static void onFramebufferSize(GLFWwindow *window, int width, int height);
+static void onWindowRefresh(GLFWwindow *window);
+static void markWindowDirty(GLFWwindow *window);
+
 void app_Run(App *app, APP_Result *result) {
     *result = APP_ERROR;
 
@@ -27,20 +40,52 @@ void app_InitWindow(App *app) {
     glfwInit();
 
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+    // Capture files have a fixed frame size
+    glfwWindowHint(GLFW_RESIZABLE, app->captureFileName ? GLFW_FALSE : GLFW_TRUE);
 
     app->window = glfwCreateWindow(WIDTH, HEIGHT, "Vulkan", NULL, NULL);
+
+    // Anything that can change what's on screen marks the scene dirty for on-demand rendering
+    glfwSetWindowUserPointer(app->window, app);
+    glfwSetKeyCallback(app->window, onKey);
+    glfwSetCursorPosCallback(app->window, onCursorPos);
+    glfwSetMouseButtonCallback(app->window, onMouseButton);
+    glfwSetScrollCallback(app->window, onScroll);
+    glfwSetFramebufferSizeCallback(app->window, onFramebufferSize);
+    glfwSetWindowRefreshCallback(app->window, onWindowRefresh);
+    atomic_store(&app->sceneDirty, true); // The first frame
 }
 
 void app_InitVulkan(App *app) {
     app_CreateVkInstance(app);
     app_SetupDebugMessenger(app);
-    app_CreateSurface(app);
+    if (!app->headless) {
+        app_CreateSurface(app);
+    }
     app_PickPhysicalDevice(app);
     app_CreateLogicalDevice(app);
-    app_CreateSwapChain(app);
+    if (app->headless) {
+        app_CreateOffscreenTargets(app);
+    } else {
+        app_CreateSwapChain(app);
+    }
     app_CreateImageViews(app);
+    app_CreateRenderPass(app);
+    app_CreatePipelineCache(app);
     app_CreateGraphicsPipeline(app);
+    app_CreateFramebuffers(app);
+    app_CreateCommandPool(app);
+    app_CreateCommandBuffers(app);
+    app_CreateSyncObjects(app);
+    if (app->captureFileName) {
+        app->pReadback = readback_Create(app, app->captureFileName);
+    }
+    if (!app->headless) {
+        app->pFramePacer = framePacer_Create(app, app->lowLatency);
+    }
+    if (app->simulationHz) {
+        app->pSimulation = simulation_Create(app, app->simulationHz);
+    }
 }
 
 void app_CreateSwapChain(App *app) {
@@ -70,6 +115,14 @@ void app_CreateSwapChain(App *app) {
     createInfo.imageExtent = extent;
     createInfo.imageArrayLayers = 1;
     createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    if (app->captureFileName) {
+        if (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) {
+            createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        } else {
+            fprintf(stderr, "Swap chain images can't be copied from on this surface, frame capture disabled.\n");
+            app->captureFileName = NULL;
+        }
+    }
 
     struct QueueFamilyIndicies indicies = findQueueFamilies(app->physicalDevice, app->surface);
     uint32_t queueFamilyIndicies[] = {indicies.graphicsFamily.value, indicies.presentFamily.value };
@@ -90,7 +143,8 @@ void app_CreateSwapChain(App *app) {
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
 
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    // Set when recreating, lets the driver hand resources over to the new swap chain
+    createInfo.oldSwapchain = app->swapChain;
 
     if (vkCreateSwapchainKHR(app->device, &createInfo, NULL, &app->swapChain) != VK_SUCCESS) {
         THROW("Failed to create swap chain");
@@ -105,6 +159,53 @@ void app_CreateSwapChain(App *app) {
     app->swapChainExtent = extent;
 }
 
+void app_RecreateSwapChain(App *app) {
+    // A minimized window has a zero sized framebuffer, nothing can be presented until it's restored
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(app->window, &width, &height);
+    while ((width == 0 || height == 0) && !glfwWindowShouldClose(app->window)) {
+        glfwWaitEvents();
+        glfwGetFramebufferSize(app->window, &width, &height);
+    }
+    // Closed while minimized: there's no valid extent to create a swap chain with, and app_MainLoop is about to exit
+    if (width == 0 || height == 0)
+        return;
+
+    // Present ids are per swap chain: measure the last frame presented to the old one while it's still around
+    if (app->pFramePacer) {
+        framePacer_SettleIdle(app->pFramePacer, app);
+    }
+
+    // Frames in flight still use the old resources. Rather than waiting for the device to go idle, they're destroyed
+    // once those frames complete. Presentation has no completion signal (short of VK_EXT_swapchain_maintenance1),
+    // so the old swap chain and the semaphores its presents wait on are kept MAX_FRAMES_IN_FLIGHT frames longer.
+    for (uint32_t i = 0; i < app->swapChainImageCount; i++) {
+        app_DeferDestroy(app, DEFERRED_FRAMEBUFFER, (DeferredHandle){ .framebuffer = app->pSwapChainFramebuffers[i] });
+        app_DeferDestroy(app, DEFERRED_IMAGE_VIEW, (DeferredHandle){ .imageView = app->pSwapChainImageViews[i] });
+    }
+    const uint64_t presentedFrame = app->frameCount + MAX_FRAMES_IN_FLIGHT;
+    for (uint32_t i = 0; i < app->swapChainImageCount; i++) {
+        deletionQueue_Push(&app->deletionQueue, DEFERRED_SEMAPHORE,
+                (DeferredHandle){ .semaphore = app->pRenderFinishedSemaphores[i] }, presentedFrame);
+    }
+    free(app->pSwapChainFramebuffers);
+    free(app->pSwapChainImageViews);
+    free(app->pRenderFinishedSemaphores);
+    free(app->pSwapChainImages);
+
+    VkSwapchainKHR oldSwapChain = app->swapChain;
+    app_CreateSwapChain(app);
+    deletionQueue_Push(&app->deletionQueue, DEFERRED_SWAPCHAIN, (DeferredHandle){ .swapChain = oldSwapChain }, presentedFrame);
+
+    // The render pass and pipeline don't depend on the extent (viewport and scissor are dynamic)
+    app_CreateImageViews(app);
+    app_CreateFramebuffers(app);
+    app_CreateRenderFinishedSemaphores(app);
+
+    app->framebufferResized = false;
+    atomic_store(&app->sceneDirty, true);
+}
+
 void app_CreateImageViews(App *app) {
     app->pSwapChainImageViews = (VkImageView *)malloc(app->swapChainImageCount * sizeof(VkImageView));
 
@@ -132,7 +233,84 @@ void app_CreateImageViews(App *app) {
     }
 }
 
+void app_CreateRenderPass(App *app) {
+    VkAttachmentDescription colorAttachment = {0};
+    colorAttachment.format = app->swapChainImageFormat;
+    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    // Offscreen images are never presented, leave them ready to be copied out instead
+    colorAttachment.finalLayout = app->headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    VkAttachmentReference colorAttachmentRef = {0};
+    colorAttachmentRef.attachment = 0;
+    colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass = {0};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorAttachmentRef;
+
+    // Wait for the image to be released by the presentation engine before writing to it
+    VkSubpassDependency dependency = {0};
+    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependency.dstSubpass = 0;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.srcAccessMask = 0;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    VkRenderPassCreateInfo renderPassInfo = {0};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &colorAttachment;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+    renderPassInfo.dependencyCount = 1;
+    renderPassInfo.pDependencies = &dependency;
+
+    if (vkCreateRenderPass(app->device, &renderPassInfo, NULL, &app->renderPass) != VK_SUCCESS) {
+        THROW("Failed to create render pass!");
+    }
+}
+
+void app_CreatePipelineCache(App *app) {
+    VkPipelineCacheCreateInfo cacheInfo = {0};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = 0;
+    cacheInfo.pInitialData = NULL;
+
+    if (vkCreatePipelineCache(app->device, &cacheInfo, NULL, &app->pipelineCache) != VK_SUCCESS) {
+        THROW("Failed to create pipeline cache!");
+    }
+}
+
 void app_CreateGraphicsPipeline(App *app) {
+    VkPushConstantRange pushConstantRange = {0};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {0};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 0; // Optional
+    pipelineLayoutInfo.pSetLayouts = NULL; // Optional
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(app->device, &pipelineLayoutInfo, NULL, &app->pipelineLayout) != VK_SUCCESS) {
+        THROW("failed to create pipeline layout!");
+    }
+
+    app->graphicsPipeline = createGraphicsPipeline(app, VK_CULL_MODE_BACK_BIT);
+}
+
+// Builds a pipeline against app->pipelineLayout and app->renderPass, through app->pipelineCache. Variants only differ in cull mode,
+// which is enough to get distinct pipeline objects to switch between.
+VkPipeline createGraphicsPipeline(App *app, VkCullModeFlags cullMode) {
     size_t vertShaderSize, fragShaderSize;
     uint32_t *pVertShader = readShaderSource("shaders/bin/vert.spv", &vertShaderSize);
     uint32_t *pFragShader = readShaderSource("shaders/bin/frag.spv", &fragShaderSize);
@@ -140,6 +318,17 @@ void app_CreateGraphicsPipeline(App *app) {
     VkShaderModule vertShaderModule = createShaderModule(app->device, pVertShader, vertShaderSize);
     VkShaderModule fragShaderModule = createShaderModule(app->device, pFragShader, fragShaderSize);
 
+    VkPipeline pipeline = createGraphicsPipelineFromModules(app, vertShaderModule, fragShaderModule, cullMode);
+
+    vkDestroyShaderModule(app->device, vertShaderModule, NULL);
+    vkDestroyShaderModule(app->device, fragShaderModule, NULL);
+    free(pVertShader);
+    free(pFragShader);
+
+    return pipeline;
+}
+
+VkPipeline createGraphicsPipelineFromModules(App *app, VkShaderModule vertShaderModule, VkShaderModule fragShaderModule, VkCullModeFlags cullMode) {
     VkPipelineShaderStageCreateInfo vertShaderStageInfo = {0};
     vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
@@ -201,7 +390,7 @@ void app_CreateGraphicsPipeline(App *app) {
     rasterizer.rasterizerDiscardEnable = VK_FALSE;
     rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
     rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+    rasterizer.cullMode = cullMode;
     rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
     rasterizer.depthBiasEnable = VK_FALSE;
     rasterizer.depthBiasConstantFactor = 0.0f;
@@ -241,24 +430,386 @@ void app_CreateGraphicsPipeline(App *app) {
     colorBlending.blendConstants[2] = 0.0f; // Optional
     colorBlending.blendConstants[3] = 0.0f; // Optional
 
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {0};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0; // Optional
-    pipelineLayoutInfo.pSetLayouts = NULL; // Optional
-    pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
-    pipelineLayoutInfo.pPushConstantRanges = NULL; // Optional
+    VkGraphicsPipelineCreateInfo pipelineInfo = {0};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = NULL; // Optional
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = app->pipelineLayout;
+    pipelineInfo.renderPass = app->renderPass;
+    pipelineInfo.subpass = 0;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
+    pipelineInfo.basePipelineIndex = -1; // Optional
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(app->device, app->pipelineCache, 1, &pipelineInfo, NULL, &pipeline) != VK_SUCCESS) {
+        THROW("Failed to create graphics pipeline!");
+    }
 
-    if (vkCreatePipelineLayout(app->device, &pipelineLayoutInfo, NULL, &app->pipelineLayout) != VK_SUCCESS) {
-        THROW("failed to create pipeline layout!");
+    return pipeline;
+}
+
+void app_CreateFramebuffers(App *app) {
+    app->pSwapChainFramebuffers = (VkFramebuffer *)calloc(app->swapChainImageCount, sizeof(VkFramebuffer));
+    if (!app->pSwapChainFramebuffers) {
+        THROW("malloc fail in app_CreateFramebuffers");
     }
 
-    vkDestroyShaderModule(app->device, vertShaderModule, NULL);
-    vkDestroyShaderModule(app->device, fragShaderModule, NULL);
+    for (uint32_t i = 0; i < app->swapChainImageCount; i++) {
+        VkImageView attachments[] = { app->pSwapChainImageViews[i] };
+
+        VkFramebufferCreateInfo framebufferInfo = {0};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = app->renderPass;
+        framebufferInfo.attachmentCount = 1;
+        framebufferInfo.pAttachments = attachments;
+        framebufferInfo.width = app->swapChainExtent.width;
+        framebufferInfo.height = app->swapChainExtent.height;
+        framebufferInfo.layers = 1;
+
+        if (vkCreateFramebuffer(app->device, &framebufferInfo, NULL, &app->pSwapChainFramebuffers[i]) != VK_SUCCESS) {
+            THROW("Failed to create framebuffer!");
+        }
+    }
+}
+
+void app_CreateCommandPool(App *app) {
+    struct QueueFamilyIndicies indicies = findQueueFamilies(app->physicalDevice, app->surface);
+
+    VkCommandPoolCreateInfo poolInfo = {0};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = indicies.graphicsFamily.value;
+
+    if (vkCreateCommandPool(app->device, &poolInfo, NULL, &app->commandPool) != VK_SUCCESS) {
+        THROW("Failed to create command pool!");
+    }
+}
+
+void app_CreateCommandBuffers(App *app) {
+    VkCommandBufferAllocateInfo allocInfo = {0};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = app->commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = MAX_FRAMES_IN_FLIGHT;
+
+    if (vkAllocateCommandBuffers(app->device, &allocInfo, app->commandBuffers) != VK_SUCCESS) {
+        THROW("Failed to allocate command buffers!");
+    }
+}
+
+void app_CreateSyncObjects(App *app) {
+    VkSemaphoreCreateInfo semaphoreInfo = {0};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        if (vkCreateSemaphore(app->device, &semaphoreInfo, NULL, &app->imageAvailableSemaphores[i]) != VK_SUCCESS) {
+            THROW("Failed to create synchronization objects for a frame!");
+        }
+    }
+
+    // Starts at 0: no frame has completed yet, so waiting for 0 completed frames never blocks
+    VkSemaphoreTypeCreateInfo timelineInfo = {0};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo timelineSemaphoreInfo = {0};
+    timelineSemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    timelineSemaphoreInfo.pNext = &timelineInfo;
+
+    if (vkCreateSemaphore(app->device, &timelineSemaphoreInfo, NULL, &app->frameTimeline) != VK_SUCCESS) {
+        THROW("Failed to create frame timeline semaphore!");
+    }
+
+    app_CreateRenderFinishedSemaphores(app);
+}
+
+void app_CreateRenderFinishedSemaphores(App *app) {
+    VkSemaphoreCreateInfo semaphoreInfo = {0};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    // The presentation engine may still be reading a renderFinished semaphore when the frame slot comes around again,
+    // so these are tied to the swap chain image they were signaled for rather than to the frame in flight.
+    app->pRenderFinishedSemaphores = (VkSemaphore *)calloc(app->swapChainImageCount, sizeof(VkSemaphore));
+    if (!app->pRenderFinishedSemaphores) {
+        THROW("malloc fail in app_CreateRenderFinishedSemaphores");
+    }
+    for (uint32_t i = 0; i < app->swapChainImageCount; i++) {
+        if (vkCreateSemaphore(app->device, &semaphoreInfo, NULL, &app->pRenderFinishedSemaphores[i]) != VK_SUCCESS) {
+            THROW("Failed to create synchronization objects for a frame!");
+        }
+    }
+}
+
+void app_RecordCommandBuffer(App *app, VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+    VkCommandBufferBeginInfo beginInfo = {0};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        THROW("Failed to begin recording command buffer!");
+    }
+
+    if (app->pFramePacer) {
+        framePacer_RecordFrameStart(app->pFramePacer, app, commandBuffer);
+    }
+
+    VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
+
+    VkRenderPassBeginInfo renderPassInfo = {0};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = app->renderPass;
+    renderPassInfo.framebuffer = app->pSwapChainFramebuffers[imageIndex];
+    renderPassInfo.renderArea.offset.x = 0;
+    renderPassInfo.renderArea.offset.y = 0;
+    renderPassInfo.renderArea.extent = app->swapChainExtent;
+    renderPassInfo.clearValueCount = 1;
+    renderPassInfo.pClearValues = &clearColor;
+
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, app->graphicsPipeline);
+
+    VkViewport viewport = {0};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = (float)app->swapChainExtent.width;
+    viewport.height = (float)app->swapChainExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor = {0};
+    scissor.offset.x = 0;
+    scissor.offset.y = 0;
+    scissor.extent = app->swapChainExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    if (app->pfnRecordDraws) {
+        app->pfnRecordDraws(app, commandBuffer, app->pRecordDrawsUserData);
+    } else if (app->pSimulation) {
+        PushConstants transforms[SIMULATION_OBJECT_COUNT];
+        simulation_Interpolate(app->pSimulation, timeNowNs(), transforms);
+        for (uint32_t i = 0; i < SIMULATION_OBJECT_COUNT; i++) {
+            vkCmdPushConstants(commandBuffer, app->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &transforms[i]);
+            vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+        }
+    } else {
+        PushConstants pushConstants = { .offset = { 0.0f, 0.0f }, .scale = 1.0f };
+        vkCmdPushConstants(commandBuffer, app->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &pushConstants);
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    }
+
+    vkCmdEndRenderPass(commandBuffer);
+
+    if (app->pReadback) {
+        readback_RecordCopy(app->pReadback, app, commandBuffer, imageIndex, app->frameCount);
+    }
+
+    if (app->pFramePacer) {
+        framePacer_RecordFrameEnd(app->pFramePacer, app, commandBuffer);
+    }
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        THROW("Failed to record command buffer!");
+    }
+}
+
+void app_DrawFrame(App *app) {
+    const uint32_t frame = app->currentFrame;
+
+    // The command buffer and semaphores of this frame slot were last used MAX_FRAMES_IN_FLIGHT frames ago
+    if (app->frameCount >= MAX_FRAMES_IN_FLIGHT) {
+        app_WaitForCompletedFrames(app, app->frameCount + 1 - MAX_FRAMES_IN_FLIGHT);
+    }
+
+    const uint64_t completedFrames = app_GetCompletedFrameCount(app);
+    if (app->pReadback) {
+        readback_Collect(app->pReadback, app->device, completedFrames);
+    }
+    deletionQueue_Drain(&app->deletionQueue, app->device, completedFrames, DELETION_QUEUE_MAX_PER_DRAIN);
+
+    uint32_t imageIndex;
+    if (app->headless) {
+        // OFFSCREEN_IMAGE_COUNT > MAX_FRAMES_IN_FLIGHT, so the image picked here is never one the GPU is still rendering to
+        imageIndex = (uint32_t)(app->frameCount % app->swapChainImageCount);
+    } else {
+        VkResult result = vkAcquireNextImageKHR(app->device, app->swapChain, UINT64_MAX, app->imageAvailableSemaphores[frame], VK_NULL_HANDLE, &imageIndex);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            // Nothing was acquired or signaled, skip the frame
+            app_RecreateSwapChain(app);
+            return;
+        }
+        if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            THROW("Failed to acquire swap chain image!");
+        }
+    }
+
+    VkCommandBuffer commandBuffer = app->commandBuffers[frame];
+    vkResetCommandBuffer(commandBuffer, 0);
+    app_RecordCommandBuffer(app, commandBuffer, imageIndex);
+
+    // Binary semaphores ignore their entry in the value arrays, the timeline is always signaled last
+    const uint64_t frameCompletedValue = app->frameCount + 1;
+    const uint64_t waitValues[] = { 0 };
+    const uint64_t signalValues[] = { 0, frameCompletedValue };
+    VkSemaphore signalSemaphores[] = { VK_NULL_HANDLE, app->frameTimeline };
+    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {0};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+
+    VkSubmitInfo submitInfo = {0};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    if (app->headless) {
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &signalSemaphores[1];
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &signalValues[1];
+    } else {
+        signalSemaphores[0] = app->pRenderFinishedSemaphores[imageIndex];
+
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &app->imageAvailableSemaphores[frame];
+        submitInfo.pWaitDstStageMask = waitStages;
+        submitInfo.signalSemaphoreCount = 2;
+        submitInfo.pSignalSemaphores = signalSemaphores;
+        timelineInfo.waitSemaphoreValueCount = 1;
+        timelineInfo.pWaitSemaphoreValues = waitValues;
+        timelineInfo.signalSemaphoreValueCount = 2;
+        timelineInfo.pSignalSemaphoreValues = signalValues;
+    }
+
+    if (vkQueueSubmit(app->graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        THROW("Failed to submit draw command buffer!");
+    }
+
+    if (app->pFramePacer) {
+        framePacer_MarkSubmitted(app->pFramePacer, app);
+    }
+
+    if (!app->headless) {
+        // Frame N is presented with id N + 1 (ids must be non-zero and increasing), see framePacer_WaitForNextFrame
+        const uint64_t presentIdValue = app->frameCount + 1;
+        VkPresentIdKHR presentId = {0};
+        presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+        presentId.swapchainCount = 1;
+        presentId.pPresentIds = &presentIdValue;
+
+        VkPresentInfoKHR presentInfo = {0};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &app->pRenderFinishedSemaphores[imageIndex];
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = &app->swapChain;
+        presentInfo.pImageIndices = &imageIndex;
+        if (app->deviceFeatures.presentWait) {
+            presentInfo.pNext = &presentId;
+        }
+
+        VkResult result = vkQueuePresentKHR(app->presentQueue, &presentInfo);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+            app->framebufferResized = true;
+        } else if (result != VK_SUCCESS) {
+            THROW("Failed to present swap chain image!");
+        }
+    }
+
+    app->currentFrame = (app->currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    app->frameCount++;
+
+    // After the frame counters moved on, so the old resources are tagged with this frame too
+    if (app->framebufferResized) {
+        app_RecreateSwapChain(app);
+    }
+}
+
+uint64_t app_GetCompletedFrameCount(App *app) {
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(app->device, app->frameTimeline, &value);
+    return value;
+}
+
+void app_WaitForCompletedFrames(App *app, uint64_t completedFrames) {
+    VkSemaphoreWaitInfo waitInfo = {0};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &app->frameTimeline;
+    waitInfo.pValues = &completedFrames;
+
+    if (vkWaitSemaphores(app->device, &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+        THROW("Failed to wait for frame timeline!");
+    }
 }
 
 void app_MainLoop(App *app) {
+    const uint64_t startNs = timeNowNs();
+    const uint64_t startCpuNs = cpuTimeNs();
+    const uint64_t startFrameCount = app->frameCount;
+
     while (!glfwWindowShouldClose(app->window)) {
+        if (app->onDemand && !app->animating && !atomic_load(&app->sceneDirty)) {
+            // Nothing changed: finish off the last frame, then sleep until an event or app_MarkDirty
+            framePacer_SettleIdle(app->pFramePacer, app);
+            if (app->pReadback) {
+                app_WaitForCompletedFrames(app, app->frameCount);
+                readback_Collect(app->pReadback, app->device, app->frameCount);
+            }
+            glfwWaitEvents();
+            app->idleWakeups++;
+            continue;
+        }
+
+        // Wait for the GPU and display first, so input is sampled as late as possible before it's used
+        framePacer_WaitForNextFrame(app->pFramePacer, app);
         glfwPollEvents();
+        framePacer_MarkInputSampled(app->pFramePacer, app);
+        // Cleared before drawing, so changes made from now on get a frame of their own
+        atomic_store(&app->sceneDirty, false);
+        app_DrawFrame(app);
+    }
+
+    vkDeviceWaitIdle(app->device);
+
+    double wallS = (double)(timeNowNs() - startNs) / 1e9;
+    double cpuS = (double)(cpuTimeNs() - startCpuNs) / 1e9;
+    fprintf(stderr, "Rendered %lu frames in %.1f s (%lu idle wakeups), CPU time %.2f s (%.1f%% of one core)\n",
+            (unsigned long)(app->frameCount - startFrameCount), wallS, (unsigned long)app->idleWakeups,
+            cpuS, wallS > 0.0 ? cpuS / wallS * 100.0 : 0.0);
+
+    LatencyStats stats = framePacer_GetStats(app->pFramePacer);
+    fprintf(stderr, "Input to %s latency: %.2f ms avg, %.2f ms max (last %u frames). CPU %.2f ms, GPU %.2f ms, paced sleep %.2f ms per frame\n",
+            stats.presentWait ? "present" : "GPU completion", stats.inputToPresentAvgMs, stats.inputToPresentMaxMs, stats.historyFrames,
+            stats.cpuMs, stats.gpuMs, stats.sleepAvgMs);
+
+    fprintf(stderr, "Deferred destruction: %lu resources released while rendering, %u pending at exit\n",
+            (unsigned long)app->deletionQueue.released, app->deletionQueue.count);
+}
+
+void app_DeferDestroy(App *app, DeferredResourceType type, DeferredHandle handle) {
+    deletionQueue_Push(&app->deletionQueue, type, handle, app->frameCount);
+}
+
+void app_MarkDirty(App *app) {
+    atomic_store(&app->sceneDirty, true);
+    glfwPostEmptyEvent();
+}
+
+void app_SetAnimating(App *app, bool animating) {
+    app->animating = animating;
+    if (animating) {
+        app_MarkDirty(app);
     }
 }
 
@@ -266,21 +817,68 @@ void app_Cleanup(App *app) {
     if (!app)
         return;
 
-    if (app->pSwapChainImageViews) {
-        for (uint32_t i = 0; i < app->swapChainImageCount; i++) {
-            vkDestroyImageView(app->device, app->pSwapChainImageViews[i], NULL);
-        }
-        free(app->pSwapChainImageViews);
-    }
+    // First, it may still be waking the main loop up
+    simulation_Destroy(app->pSimulation);
 
     if (app->device) {
-        if (app->swapChain) {
-            vkDestroySwapchainKHR(app->device, app->swapChain, NULL);
+        vkDeviceWaitIdle(app->device);
+
+        if (app->pReadback) {
+            readback_Destroy(app->pReadback, app->device);
+        }
+        if (app->pFramePacer) {
+            framePacer_Destroy(app->pFramePacer, app->device);
+        }
+        deletionQueue_Flush(&app->deletionQueue, app->device);
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            if (app->imageAvailableSemaphores[i]) {
+                vkDestroySemaphore(app->device, app->imageAvailableSemaphores[i], NULL);
+            }
+        }
+        if (app->frameTimeline) {
+            vkDestroySemaphore(app->device, app->frameTimeline, NULL);
+        }
+        if (app->pRenderFinishedSemaphores) {
+            for (uint32_t i = 0; i < app->swapChainImageCount; i++) {
+                vkDestroySemaphore(app->device, app->pRenderFinishedSemaphores[i], NULL);
+            }
+            free(app->pRenderFinishedSemaphores);
+        }
+        if (app->commandPool) {
+            vkDestroyCommandPool(app->device, app->commandPool, NULL);
+        }
+        if (app->pSwapChainFramebuffers) {
+            for (uint32_t i = 0; i < app->swapChainImageCount; i++) {
+                vkDestroyFramebuffer(app->device, app->pSwapChainFramebuffers[i], NULL);
+            }
+            free(app->pSwapChainFramebuffers);
+        }
+        if (app->graphicsPipeline) {
+            vkDestroyPipeline(app->device, app->graphicsPipeline, NULL);
+        }
+        if (app->pipelineCache) {
+            vkDestroyPipelineCache(app->device, app->pipelineCache, NULL);
         }
         if (app->pipelineLayout) {
             vkDestroyPipelineLayout(app->device, app->pipelineLayout, NULL);
         }
+        if (app->renderPass) {
+            vkDestroyRenderPass(app->device, app->renderPass, NULL);
+        }
+        if (app->pSwapChainImageViews) {
+            for (uint32_t i = 0; i < app->swapChainImageCount; i++) {
+                vkDestroyImageView(app->device, app->pSwapChainImageViews[i], NULL);
+            }
+            free(app->pSwapChainImageViews);
+        }
+        if (app->swapChain) {
+            vkDestroySwapchainKHR(app->device, app->swapChain, NULL);
+        }
+        if (app->headless) {
+            app_DestroyOffscreenTargets(app);
+        }
         vkDestroyDevice(app->device, NULL);
+        vkLoader_UnloadDevice(app->device);
     }
 
     if (app->pSwapChainImages) {
@@ -289,7 +887,7 @@ void app_Cleanup(App *app) {
     
 
     if (app->instance) {
-        if (enableValidationLayers) {
+        if (app->validationEnabled) {
            vkDebugUtilsMessengerEXT_Destroy(app->instance, app->debugMessenger, NULL); 
         }
         if (app->surface) {
@@ -303,3 +901,38 @@ void app_Cleanup(App *app) {
         glfwTerminate();
     }
 }
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+static void onKey(GLFWwindow *window, int key, int scancode, int action, int mods) {
+    markWindowDirty(window);
+}
+
+static void onCursorPos(GLFWwindow *window, double x, double y) {
+    markWindowDirty(window);
+}
+
+static void onMouseButton(GLFWwindow *window, int button, int action, int mods) {
+    markWindowDirty(window);
+}
+
+static void onScroll(GLFWwindow *window, double dx, double dy) {
+    markWindowDirty(window);
+}
+
+static void onFramebufferSize(GLFWwindow *window, int width, int height) {
+    App *app = (App *)glfwGetWindowUserPointer(window);
+    app->framebufferResized = true;
+    markWindowDirty(window);
+}
+
+// Window exposed or damaged, its content has to be presented again
+static void onWindowRefresh(GLFWwindow *window) {
+    markWindowDirty(window);
+}
+
+// Callbacks run on the main thread inside glfwPollEvents/glfwWaitEvents, so there's no need to post an event
+static void markWindowDirty(GLFWwindow *window) {
+    App *app = (App *)glfwGetWindowUserPointer(window);
+    atomic_store(&app->sceneDirty, true);
+}
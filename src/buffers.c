@@ -0,0 +1,64 @@
+#include <buffers.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <utils.h>
+
+OptionalUint32 queryMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+    OptionalUint32 memoryType = {0};
+
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            memoryType.value = i;
+            memoryType.hasValue = true;
+            break;
+        }
+    }
+
+    return memoryType;
+}
+
+uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+    OptionalUint32 memoryType = queryMemoryType(physicalDevice, typeFilter, properties);
+    if (!memoryType.hasValue) {
+        THROW("Failed to find suitable memory type!");
+    }
+
+    return memoryType.value;
+}
+
+void createBuffer(
+        VkPhysicalDevice physicalDevice,
+        VkDevice device,
+        VkDeviceSize size,
+        VkBufferUsageFlags usage,
+        VkMemoryPropertyFlags properties,
+        VkBuffer *pBuffer,
+        VkDeviceMemory *pBufferMemory) {
+
+    VkBufferCreateInfo bufferInfo = {0};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &bufferInfo, NULL, pBuffer) != VK_SUCCESS) {
+        THROW("Failed to create buffer!");
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device, *pBuffer, &memRequirements);
+
+    VkMemoryAllocateInfo allocInfo = {0};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memRequirements.size;
+    allocInfo.memoryTypeIndex = findMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties);
+
+    if (vkAllocateMemory(device, &allocInfo, NULL, pBufferMemory) != VK_SUCCESS) {
+        THROW("Failed to allocate buffer memory!");
+    }
+
+    vkBindBufferMemory(device, *pBuffer, *pBufferMemory, 0);
+}
@@ -0,0 +1,91 @@
+#include <deletion_queue.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utils.h>
+
+static void growQueue(DeletionQueue *queue);
+static void destroyResource(VkDevice device, const DeferredDestroy *entry);
+
+void deletionQueue_Push(DeletionQueue *queue, DeferredResourceType type, DeferredHandle handle, uint64_t releaseFrame) {
+    if (queue->count == queue->capacity) {
+        growQueue(queue);
+    }
+
+    DeferredDestroy *entry = &queue->pEntries[(queue->head + queue->count) % queue->capacity];
+    entry->type = type;
+    entry->handle = handle;
+    entry->releaseFrame = releaseFrame;
+    queue->count++;
+}
+
+void deletionQueue_Drain(DeletionQueue *queue, VkDevice device, uint64_t completedFrames, uint32_t maxCount) {
+    for (uint32_t i = 0; i < maxCount && queue->count > 0; i++) {
+        const DeferredDestroy *entry = &queue->pEntries[queue->head];
+        if (entry->releaseFrame > completedFrames)
+            break;
+
+        destroyResource(device, entry);
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+        queue->released++;
+    }
+}
+
+void deletionQueue_Flush(DeletionQueue *queue, VkDevice device) {
+    deletionQueue_Drain(queue, device, UINT64_MAX, UINT32_MAX);
+    free(queue->pEntries);
+    memset(queue, 0, sizeof(DeletionQueue));
+}
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+// Doubles the capacity, unwrapping the ring so the oldest entry ends up first
+static void growQueue(DeletionQueue *queue) {
+    uint32_t capacity = queue->capacity ? queue->capacity * 2 : 64;
+    DeferredDestroy *pEntries = (DeferredDestroy *)malloc(capacity * sizeof(DeferredDestroy));
+    if (!pEntries) {
+        THROW("malloc fail in growQueue");
+    }
+
+    for (uint32_t i = 0; i < queue->count; i++) {
+        pEntries[i] = queue->pEntries[(queue->head + i) % queue->capacity];
+    }
+
+    free(queue->pEntries);
+    queue->pEntries = pEntries;
+    queue->capacity = capacity;
+    queue->head = 0;
+}
+
+static void destroyResource(VkDevice device, const DeferredDestroy *entry) {
+    switch (entry->type) {
+    case DEFERRED_BUFFER:
+        vkDestroyBuffer(device, entry->handle.buffer, NULL);
+        break;
+    case DEFERRED_IMAGE:
+        vkDestroyImage(device, entry->handle.image, NULL);
+        break;
+    case DEFERRED_IMAGE_VIEW:
+        vkDestroyImageView(device, entry->handle.imageView, NULL);
+        break;
+    case DEFERRED_MEMORY:
+        vkFreeMemory(device, entry->handle.memory, NULL);
+        break;
+    case DEFERRED_FRAMEBUFFER:
+        vkDestroyFramebuffer(device, entry->handle.framebuffer, NULL);
+        break;
+    case DEFERRED_PIPELINE:
+        vkDestroyPipeline(device, entry->handle.pipeline, NULL);
+        break;
+    case DEFERRED_SEMAPHORE:
+        vkDestroySemaphore(device, entry->handle.semaphore, NULL);
+        break;
+    case DEFERRED_SWAPCHAIN:
+        vkDestroySwapchainKHR(device, entry->handle.swapChain, NULL);
+        break;
+    case DEFERRED_COMMAND_BUFFER:
+        vkFreeCommandBuffers(device, entry->handle.commandBuffer.pool, 1, &entry->handle.commandBuffer.buffer);
+        break;
+    }
+}
@@ -0,0 +1,226 @@
+#include <frame_pacer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <utils.h>
+
+// Don't hang on a present that never completes (e.g. minimized window), just stop pacing for that frame
+#define PRESENT_WAIT_TIMEOUT_NS 100000000ull
+
+// Weight of the newest sample in the moving averages
+#define EMA_WEIGHT 0.1
+
+static void createTimestampPool(FramePacer *pacer, App *app);
+static uint64_t measurePreviousPresent(FramePacer *pacer, App *app);
+static void readGpuTimestamps(FramePacer *pacer, App *app, uint32_t slot);
+static void recordLatency(FramePacer *pacer, double latencyNs);
+static double updateEma(double average, double sample);
+static void sleepNs(uint64_t ns);
+
+FramePacer *framePacer_Create(App *app, bool lowLatency) {
+    FramePacer *pacer = (FramePacer *)calloc(1, sizeof(FramePacer));
+    if (!pacer) {
+        THROW("malloc fail in framePacer_Create");
+    }
+
+    pacer->lowLatency = lowLatency;
+    // NULL unless VK_KHR_present_wait was enabled on the device
+    pacer->presentWait = app->deviceFeatures.presentWait && vkWaitForPresentKHR != NULL;
+
+    createTimestampPool(pacer, app);
+
+    return pacer;
+}
+
+void framePacer_Destroy(FramePacer *pacer, VkDevice device) {
+    if (!pacer)
+        return;
+
+    if (pacer->timestampPool) {
+        vkDestroyQueryPool(device, pacer->timestampPool, NULL);
+    }
+    free(pacer);
+}
+
+void framePacer_WaitForNextFrame(FramePacer *pacer, App *app) {
+    const uint64_t frame = app->frameCount;
+    const uint32_t slot = (uint32_t)(frame % MAX_FRAMES_IN_FLIGHT);
+    if (frame == 0)
+        return;
+
+    uint64_t presentedNs = 0;
+    if (pacer->lowLatency) {
+        // Keep at most one frame queued: the previous one has to reach the screen before input is sampled again.
+        // Already done by framePacer_SettleIdle if the app went idle after the previous frame.
+        if (pacer->settledFrameCount != frame) {
+            presentedNs = measurePreviousPresent(pacer, app);
+        }
+    } else if (frame >= MAX_FRAMES_IN_FLIGHT) {
+        // Throughput mode: only measure. The frame reusing this slot is observed complete here, which is an
+        // upper bound of when it reached the presentation engine (a useless one if the app idled since).
+        app_WaitForCompletedFrames(app, frame + 1 - MAX_FRAMES_IN_FLIGHT);
+        if (pacer->frames[slot].inputSampleNs && pacer->settledFrameCount < frame + 1 - MAX_FRAMES_IN_FLIGHT) {
+            recordLatency(pacer, (double)(timeNowNs() - pacer->frames[slot].inputSampleNs));
+        }
+    }
+
+    // The frame that last used this slot is complete in both modes, its timestamps can be read without waiting
+    readGpuTimestamps(pacer, app, slot);
+
+    // Start the next frame as late as possible while still making the next present: whatever part of the present
+    // interval the frame isn't predicted to need is spent here, before input is sampled, instead of after.
+    if (pacer->lowLatency && presentedNs && pacer->presentIntervalEmaNs > 0.0) {
+        double predictedNs = pacer->cpuEmaNs + pacer->gpuEmaNs + FRAME_PACER_MARGIN_NS;
+        double elapsedNs = (double)(timeNowNs() - presentedNs);
+        double slackNs = pacer->presentIntervalEmaNs - predictedNs - elapsedNs;
+        if (slackNs > 0.0) {
+            sleepNs((uint64_t)slackNs);
+            pacer->sleepTotalNs += slackNs;
+        }
+    }
+    pacer->framesPaced++;
+}
+
+void framePacer_SettleIdle(FramePacer *pacer, App *app) {
+    if (app->frameCount == 0 || pacer->settledFrameCount == app->frameCount)
+        return;
+
+    if (pacer->lowLatency) {
+        measurePreviousPresent(pacer, app);
+    }
+    // The idle gap that follows isn't a present interval
+    pacer->lastPresentNs = 0;
+    pacer->settledFrameCount = app->frameCount;
+}
+
+void framePacer_MarkInputSampled(FramePacer *pacer, App *app) {
+    pacer->frames[app->frameCount % MAX_FRAMES_IN_FLIGHT].inputSampleNs = timeNowNs();
+}
+
+void framePacer_RecordFrameStart(FramePacer *pacer, App *app, VkCommandBuffer commandBuffer) {
+    if (!pacer->timestampPool)
+        return;
+
+    const uint32_t slot = app->currentFrame;
+    vkCmdResetQueryPool(commandBuffer, pacer->timestampPool, slot * 2, 2);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pacer->timestampPool, slot * 2);
+}
+
+void framePacer_RecordFrameEnd(FramePacer *pacer, App *app, VkCommandBuffer commandBuffer) {
+    if (!pacer->timestampPool)
+        return;
+
+    const uint32_t slot = app->currentFrame;
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, pacer->timestampPool, slot * 2 + 1);
+    pacer->frames[slot].gpuTimestampsWritten = true;
+}
+
+void framePacer_MarkSubmitted(FramePacer *pacer, App *app) {
+    FrameTiming *timing = &pacer->frames[app->currentFrame];
+    timing->submitNs = timeNowNs();
+    if (timing->inputSampleNs) {
+        pacer->cpuEmaNs = updateEma(pacer->cpuEmaNs, (double)(timing->submitNs - timing->inputSampleNs));
+    }
+}
+
+LatencyStats framePacer_GetStats(const FramePacer *pacer) {
+    LatencyStats stats = {0};
+    // Present wait is only used to measure latency in low latency mode, it's GPU completion otherwise
+    stats.presentWait = pacer->presentWait && pacer->lowLatency;
+    stats.frames = pacer->latencySamples;
+    stats.cpuMs = pacer->cpuEmaNs / 1e6;
+    stats.gpuMs = pacer->gpuEmaNs / 1e6;
+    stats.sleepAvgMs = pacer->framesPaced ? pacer->sleepTotalNs / 1e6 / (double)pacer->framesPaced : 0.0;
+
+    uint32_t count = pacer->latencySamples < FRAME_PACER_HISTORY ? (uint32_t)pacer->latencySamples : FRAME_PACER_HISTORY;
+    double sum = 0.0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += pacer->latencyHistoryNs[i];
+        if (pacer->latencyHistoryNs[i] / 1e6 > stats.inputToPresentMaxMs) {
+            stats.inputToPresentMaxMs = pacer->latencyHistoryNs[i] / 1e6;
+        }
+    }
+    stats.historyFrames = count;
+    stats.inputToPresentAvgMs = count ? sum / 1e6 / count : 0.0;
+
+    return stats;
+}
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+static void createTimestampPool(FramePacer *pacer, App *app) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(app->physicalDevice, &properties);
+    if (!properties.limits.timestampComputeAndGraphics) {
+        return;
+    }
+    pacer->timestampPeriodNs = properties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo poolInfo = {0};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = MAX_FRAMES_IN_FLIGHT * 2;
+
+    if (vkCreateQueryPool(app->device, &poolInfo, NULL, &pacer->timestampPool) != VK_SUCCESS) {
+        pacer->timestampPool = VK_NULL_HANDLE;
+    }
+}
+
+// Waits for the frame before app->frameCount to be presented and records its latency. Returns when it was
+// observed presented, or 0 if that timed out.
+static uint64_t measurePreviousPresent(FramePacer *pacer, App *app) {
+    const uint64_t previous = app->frameCount - 1;
+    const FrameTiming *previousTiming = &pacer->frames[previous % MAX_FRAMES_IN_FLIGHT];
+
+    uint64_t presentedNs = 0;
+    if (pacer->presentWait) {
+        // Frame N is presented with id N + 1
+        if (vkWaitForPresentKHR(app->device, app->swapChain, previous + 1, PRESENT_WAIT_TIMEOUT_NS) == VK_SUCCESS) {
+            presentedNs = timeNowNs();
+        }
+    } else {
+        // Without present wait, GPU completion is the closest observable point to the present
+        app_WaitForCompletedFrames(app, app->frameCount);
+        presentedNs = timeNowNs();
+    }
+
+    if (presentedNs && previousTiming->inputSampleNs) {
+        recordLatency(pacer, (double)(presentedNs - previousTiming->inputSampleNs));
+        if (pacer->lastPresentNs) {
+            pacer->presentIntervalEmaNs = updateEma(pacer->presentIntervalEmaNs, (double)(presentedNs - pacer->lastPresentNs));
+        }
+        pacer->lastPresentNs = presentedNs;
+    }
+
+    return presentedNs;
+}
+
+static void readGpuTimestamps(FramePacer *pacer, App *app, uint32_t slot) {
+    if (!pacer->timestampPool || !pacer->frames[slot].gpuTimestampsWritten)
+        return;
+
+    uint64_t timestamps[2];
+    VkResult result = vkGetQueryPoolResults(app->device, pacer->timestampPool, slot * 2, 2,
+            sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result == VK_SUCCESS && timestamps[1] >= timestamps[0]) {
+        double gpuNs = (double)(timestamps[1] - timestamps[0]) * pacer->timestampPeriodNs;
+        pacer->gpuEmaNs = updateEma(pacer->gpuEmaNs, gpuNs);
+    }
+}
+
+static void recordLatency(FramePacer *pacer, double latencyNs) {
+    pacer->latencyHistoryNs[pacer->latencyHistoryNext] = latencyNs;
+    pacer->latencyHistoryNext = (pacer->latencyHistoryNext + 1) % FRAME_PACER_HISTORY;
+    pacer->latencySamples++;
+}
+
+static double updateEma(double average, double sample) {
+    return average == 0.0 ? sample : average + EMA_WEIGHT * (sample - average);
+}
+
+static void sleepNs(uint64_t ns) {
+    struct timespec duration;
+    duration.tv_sec = (time_t)(ns / 1000000000ull);
+    duration.tv_nsec = (long)(ns % 1000000000ull);
+    nanosleep(&duration, NULL);
+}
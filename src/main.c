@@ -1,10 +1,30 @@
 #include <app.h>
+#include <simulation.h>
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-int main() {
+static bool parseTickRate(const char *arg, uint32_t *outHz);
+
+int main(int argc, char **argv) {
     App app = {0};
+    app.lowLatency = true;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            app.captureFileName = argv[++i];
+        } else if (strcmp(argv[i], "--throughput") == 0) {
+            app.lowLatency = false;
+        } else if (strcmp(argv[i], "--on-demand") == 0) {
+            app.onDemand = true;
+        } else if (strcmp(argv[i], "--simulate") == 0 && i + 1 < argc && parseTickRate(argv[i + 1], &app.simulationHz)) {
+            i++;
+        } else {
+            fprintf(stderr, "Usage: %s [--capture FILE] [--throughput] [--on-demand] [--simulate HZ (1-%d)]\n", argv[0], SIMULATION_MAX_HZ);
+            return EXIT_FAILURE;
+        }
+    }
 
     APP_Result result;
     app_Run(&app, &result);
@@ -14,3 +34,15 @@ int main() {
     }
     return EXIT_SUCCESS;
 }
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+static bool parseTickRate(const char *arg, uint32_t *outHz) {
+    char *end;
+    unsigned long hz = strtoul(arg, &end, 10);
+    if (end == arg || *end != '\0' || hz < 1 || hz > SIMULATION_MAX_HZ)
+        return false;
+
+    *outHz = (uint32_t)hz;
+    return true;
+}
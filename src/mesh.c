@@ -0,0 +1,496 @@
+#include <buffers.h>
+#include <mesh.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utils.h>
+
+// Indices into the OBJ attribute arrays, 0-based, -1 when the face vertex doesn't reference that attribute
+typedef struct ObjVertexKey {
+    int32_t position;
+    int32_t uv;
+    int32_t normal;
+} ObjVertexKey;
+
+typedef struct ObjParser {
+    float (*pPositions)[3];
+    uint32_t positionCount, positionCapacity;
+    float (*pUvs)[2];
+    uint32_t uvCount, uvCapacity;
+    float (*pNormals)[3];
+    uint32_t normalCount, normalCapacity;
+
+    MeshData *mesh;
+    uint32_t vertexCapacity, indexCapacity;
+    ObjVertexKey *pVertexKeys; // Key of every vertex emitted so far
+    uint32_t *pVertexTable;    // Open addressing hash table of vertex indices, UINT32_MAX when empty
+    uint32_t vertexTableSize;  // Power of two, kept at least twice the vertex count
+} ObjParser;
+
+static char *readTextFile(const char *fileName);
+static void *growArray(void *array, uint32_t *capacity, uint32_t count, size_t elementSize);
+static const char *parseFloats(const char *p, float *out, uint32_t count);
+static const char *parseFace(ObjParser *parser, const char *p);
+static int32_t resolveObjIndex(long index, uint32_t count);
+static uint32_t emitVertex(ObjParser *parser, ObjVertexKey key);
+static uint32_t hashVertexKey(ObjVertexKey key);
+static void rehashVertices(ObjParser *parser);
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment);
+
+void mesh_LoadObj(const char *fileName, MeshData *mesh) {
+    char *source = readTextFile(fileName);
+
+    memset(mesh, 0, sizeof(MeshData));
+    ObjParser parser = {0};
+    parser.mesh = mesh;
+    rehashVertices(&parser);
+
+    const char *p = source;
+    while (*p) {
+        while (*p == ' ' || *p == '\t')
+            p++;
+
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+            parser.pPositions = growArray(parser.pPositions, &parser.positionCapacity, parser.positionCount, sizeof(float[3]));
+            p = parseFloats(p + 2, parser.pPositions[parser.positionCount++], 3);
+        } else if (p[0] == 'v' && p[1] == 't') {
+            parser.pUvs = growArray(parser.pUvs, &parser.uvCapacity, parser.uvCount, sizeof(float[2]));
+            float *uv = parser.pUvs[parser.uvCount++];
+            p = parseFloats(p + 2, uv, 2);
+            // OBJ puts the texture origin at the bottom left, Vulkan at the top left
+            uv[1] = 1.0f - uv[1];
+        } else if (p[0] == 'v' && p[1] == 'n') {
+            parser.pNormals = growArray(parser.pNormals, &parser.normalCapacity, parser.normalCount, sizeof(float[3]));
+            p = parseFloats(p + 2, parser.pNormals[parser.normalCount++], 3);
+        } else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+            p = parseFace(&parser, p + 2);
+        }
+
+        // Comments, groups, materials and anything else unsupported are skipped
+        while (*p && *p != '\n')
+            p++;
+        if (*p == '\n')
+            p++;
+    }
+
+    free(parser.pPositions);
+    free(parser.pUvs);
+    free(parser.pNormals);
+    free(parser.pVertexKeys);
+    free(parser.pVertexTable);
+    free(source);
+}
+
+void mesh_FreeData(MeshData *mesh) {
+    free(mesh->pVertices);
+    free(mesh->pIndices);
+    memset(mesh, 0, sizeof(MeshData));
+}
+
+void meshCache_Write(const char *fileName, const MeshData *mesh) {
+    static const uint8_t padding[MESH_CACHE_ALIGNMENT] = {0};
+
+    MeshCacheHeader header = {0};
+    header.magic = MESH_CACHE_MAGIC;
+    header.version = MESH_CACHE_VERSION;
+    header.vertexStride = sizeof(Vertex);
+    header.indexSize = sizeof(uint32_t);
+    header.vertexCount = mesh->vertexCount;
+    header.vertexOffset = alignUp(sizeof(MeshCacheHeader), MESH_CACHE_ALIGNMENT);
+    header.indexCount = mesh->indexCount;
+    header.indexOffset = alignUp(header.vertexOffset + header.vertexCount * sizeof(Vertex), MESH_CACHE_ALIGNMENT);
+
+    for (uint32_t axis = 0; axis < 3; axis++) {
+        header.boundsMin[axis] = mesh->vertexCount ? mesh->pVertices[0].position[axis] : 0.0f;
+        header.boundsMax[axis] = header.boundsMin[axis];
+    }
+    for (uint32_t i = 0; i < mesh->vertexCount; i++) {
+        for (uint32_t axis = 0; axis < 3; axis++) {
+            float value = mesh->pVertices[i].position[axis];
+            if (value < header.boundsMin[axis])
+                header.boundsMin[axis] = value;
+            if (value > header.boundsMax[axis])
+                header.boundsMax[axis] = value;
+        }
+    }
+
+    FILE *file = fopen(fileName, "wb");
+    if (!file) {
+        THROW("Failed to open mesh cache file for writing");
+    }
+
+    size_t vertexSize = (size_t)header.vertexCount * sizeof(Vertex);
+    size_t indexSize = (size_t)header.indexCount * sizeof(uint32_t);
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+            && fwrite(padding, 1, header.vertexOffset - sizeof(header), file) == header.vertexOffset - sizeof(header)
+            && fwrite(mesh->pVertices, 1, vertexSize, file) == vertexSize
+            && fwrite(padding, 1, header.indexOffset - header.vertexOffset - vertexSize, file) == header.indexOffset - header.vertexOffset - vertexSize
+            && fwrite(mesh->pIndices, 1, indexSize, file) == indexSize;
+
+    if (fclose(file) != 0 || !written) {
+        THROW("Failed to write mesh cache file");
+    }
+}
+
+bool meshCache_Open(const char *fileName, MeshCache *cache) {
+    memset(cache, 0, sizeof(MeshCache));
+
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || (size_t)fileStat.st_size < sizeof(MeshCacheHeader)) {
+        close(fd);
+        return false;
+    }
+
+    void *pMapped = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file alive
+    if (pMapped == MAP_FAILED)
+        return false;
+
+    // The whole file is about to be copied front to back
+    madvise(pMapped, (size_t)fileStat.st_size, MADV_SEQUENTIAL);
+    madvise(pMapped, (size_t)fileStat.st_size, MADV_WILLNEED);
+
+    cache->pMapped = pMapped;
+    cache->size = (size_t)fileStat.st_size;
+    cache->pHeader = (const MeshCacheHeader *)pMapped;
+
+    const MeshCacheHeader *header = cache->pHeader;
+    bool valid = header->magic == MESH_CACHE_MAGIC
+            && header->version == MESH_CACHE_VERSION
+            && header->vertexStride == sizeof(Vertex)
+            && header->indexSize == sizeof(uint32_t)
+            && header->vertexCount > 0 && header->vertexCount <= UINT32_MAX
+            && header->indexCount > 0 && header->indexCount <= UINT32_MAX
+            && header->vertexOffset % MESH_CACHE_ALIGNMENT == 0
+            && header->indexOffset % MESH_CACHE_ALIGNMENT == 0
+            && header->vertexOffset <= cache->size
+            && header->indexOffset <= cache->size
+            && header->vertexOffset + header->vertexCount * sizeof(Vertex) <= cache->size
+            && header->indexOffset + header->indexCount * sizeof(uint32_t) <= cache->size;
+    if (!valid) {
+        meshCache_Close(cache);
+        return false;
+    }
+
+    // An out of range index would have the GPU read past the vertex buffer
+    const uint32_t *pIndices = (const uint32_t *)((const uint8_t *)pMapped + header->indexOffset);
+    for (uint64_t i = 0; i < header->indexCount; i++) {
+        if (pIndices[i] >= header->vertexCount) {
+            meshCache_Close(cache);
+            return false;
+        }
+    }
+
+    cache->pVertices = (const Vertex *)((const uint8_t *)pMapped + header->vertexOffset);
+    cache->pIndices = pIndices;
+
+    return true;
+}
+
+void meshCache_Close(MeshCache *cache) {
+    if (cache->pMapped) {
+        munmap(cache->pMapped, cache->size);
+    }
+    memset(cache, 0, sizeof(MeshCache));
+}
+
+void mesh_Upload(App *app, const Vertex *pVertices, uint32_t vertexCount, const uint32_t *pIndices, uint32_t indexCount, GpuMesh *gpuMesh) {
+    const VkDeviceSize vertexSize = (VkDeviceSize)vertexCount * sizeof(Vertex);
+    const VkDeviceSize indexSize = (VkDeviceSize)indexCount * sizeof(uint32_t);
+    const VkDeviceSize indexStagingOffset = alignUp(vertexSize, MESH_CACHE_ALIGNMENT);
+    if (vertexCount == 0 || indexCount == 0) {
+        THROW("Cannot upload an empty mesh");
+    }
+
+    // One staging buffer for both blobs
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingMemory;
+    createBuffer(app->physicalDevice, app->device, indexStagingOffset + indexSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingMemory);
+
+    void *pMapped;
+    if (vkMapMemory(app->device, stagingMemory, 0, VK_WHOLE_SIZE, 0, &pMapped) != VK_SUCCESS) {
+        THROW("Failed to map mesh staging memory!");
+    }
+    memcpy(pMapped, pVertices, vertexSize);
+    memcpy((uint8_t *)pMapped + indexStagingOffset, pIndices, indexSize);
+    vkUnmapMemory(app->device, stagingMemory);
+
+    createBuffer(app->physicalDevice, app->device, vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &gpuMesh->vertexBuffer, &gpuMesh->vertexMemory);
+    createBuffer(app->physicalDevice, app->device, indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &gpuMesh->indexBuffer, &gpuMesh->indexMemory);
+    gpuMesh->indexCount = indexCount;
+
+    VkCommandBufferAllocateInfo allocInfo = {0};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = app->commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer;
+    if (vkAllocateCommandBuffers(app->device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+        THROW("Failed to allocate mesh upload command buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo = {0};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    VkBufferCopy vertexRegion = {0};
+    vertexRegion.srcOffset = 0;
+    vertexRegion.dstOffset = 0;
+    vertexRegion.size = vertexSize;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, gpuMesh->vertexBuffer, 1, &vertexRegion);
+
+    VkBufferCopy indexRegion = {0};
+    indexRegion.srcOffset = indexStagingOffset;
+    indexRegion.dstOffset = 0;
+    indexRegion.size = indexSize;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, gpuMesh->indexBuffer, 1, &indexRegion);
+
+    // Frames submitted after this one read the buffers without waiting on anything, submission order is enough
+    VkMemoryBarrier toVertexInput = {0};
+    toVertexInput.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    toVertexInput.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toVertexInput.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0,
+            1, &toVertexInput, 0, NULL, 0, NULL);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        THROW("Failed to record mesh upload command buffer!");
+    }
+
+    VkSubmitInfo submitInfo = {0};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    if (vkQueueSubmit(app->graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        THROW("Failed to submit mesh upload!");
+    }
+
+    // Nothing waits for the copy. The next frame is submitted after it on the same queue, so once the frame timeline
+    // shows that frame completed, the upload has too.
+    const uint64_t releaseFrame = app->frameCount + 1;
+    deletionQueue_Push(&app->deletionQueue, DEFERRED_COMMAND_BUFFER,
+            (DeferredHandle){ .commandBuffer = { app->commandPool, commandBuffer } }, releaseFrame);
+    deletionQueue_Push(&app->deletionQueue, DEFERRED_BUFFER, (DeferredHandle){ .buffer = stagingBuffer }, releaseFrame);
+    deletionQueue_Push(&app->deletionQueue, DEFERRED_MEMORY, (DeferredHandle){ .memory = stagingMemory }, releaseFrame);
+}
+
+void mesh_UploadFromCache(App *app, const MeshCache *cache, GpuMesh *gpuMesh) {
+    // Straight from the page cache into staging memory, the blobs are already in their GPU layout
+    mesh_Upload(app, cache->pVertices, (uint32_t)cache->pHeader->vertexCount,
+            cache->pIndices, (uint32_t)cache->pHeader->indexCount, gpuMesh);
+}
+
+void mesh_Destroy(VkDevice device, GpuMesh *gpuMesh) {
+    vkDestroyBuffer(device, gpuMesh->vertexBuffer, NULL);
+    vkFreeMemory(device, gpuMesh->vertexMemory, NULL);
+    vkDestroyBuffer(device, gpuMesh->indexBuffer, NULL);
+    vkFreeMemory(device, gpuMesh->indexMemory, NULL);
+    memset(gpuMesh, 0, sizeof(GpuMesh));
+}
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+static char *readTextFile(const char *fileName) {
+    FILE *file = fopen(fileName, "rb");
+    if (!file) {
+        THROW("Failed to open mesh file");
+    }
+
+    if (fseek(file, 0, SEEK_END) != 0) {
+        fclose(file);
+        THROW("Failed to seek the end of mesh file");
+    }
+
+    long fileSize = ftell(file);
+    if (fileSize < 0) {
+        fclose(file);
+        THROW("Invalid mesh file size");
+    }
+
+    rewind(file);
+
+    char *buffer = (char *)malloc((size_t)fileSize + 1);
+    if (!buffer) {
+        fclose(file);
+        THROW("malloc fail in readTextFile");
+    }
+
+    if (fread(buffer, 1, (size_t)fileSize, file) != (size_t)fileSize) {
+        free(buffer);
+        fclose(file);
+        THROW("Failed to read mesh file");
+    }
+    buffer[fileSize] = '\0';
+
+    fclose(file);
+    return buffer;
+}
+
+// Makes room for one more element, doubling the capacity
+static void *growArray(void *array, uint32_t *capacity, uint32_t count, size_t elementSize) {
+    if (count < *capacity)
+        return array;
+
+    *capacity = *capacity ? *capacity * 2 : 1024;
+    array = realloc(array, *capacity * elementSize);
+    if (!array) {
+        THROW("malloc fail in growArray");
+    }
+    return array;
+}
+
+static const char *parseFloats(const char *p, float *out, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        char *end;
+        out[i] = strtof(p, &end);
+        if (end == p) {
+            THROW("Malformed OBJ vertex attribute");
+        }
+        p = end;
+    }
+    return p;
+}
+
+// Parses the vertices of one face ("f v/vt/vn ...", vt and vn optional) and emits it as a triangle fan
+static const char *parseFace(ObjParser *parser, const char *p) {
+    MeshData *mesh = parser->mesh;
+    uint32_t first = 0;
+    uint32_t previous = 0;
+    uint32_t faceVertexCount = 0;
+
+    for (;;) {
+        while (*p == ' ' || *p == '\t' || *p == '\r')
+            p++;
+        if (*p == '\0' || *p == '\n' || *p == '#')
+            break;
+
+        char *end;
+        ObjVertexKey key = { -1, -1, -1 };
+        key.position = resolveObjIndex(strtol(p, &end, 10), parser->positionCount);
+        if (end == p) {
+            THROW("Malformed OBJ face");
+        }
+        p = end;
+        if (*p == '/') {
+            p++;
+            if (*p != '/') {
+                key.uv = resolveObjIndex(strtol(p, &end, 10), parser->uvCount);
+                p = end;
+            }
+            if (*p == '/') {
+                p++;
+                key.normal = resolveObjIndex(strtol(p, &end, 10), parser->normalCount);
+                p = end;
+            }
+        }
+
+        uint32_t vertex = emitVertex(parser, key);
+        if (faceVertexCount == 0) {
+            first = vertex;
+        } else if (faceVertexCount >= 2) {
+            mesh->pIndices = growArray(mesh->pIndices, &parser->indexCapacity, mesh->indexCount + 2, sizeof(uint32_t));
+            mesh->pIndices[mesh->indexCount++] = first;
+            mesh->pIndices[mesh->indexCount++] = previous;
+            mesh->pIndices[mesh->indexCount++] = vertex;
+        }
+        previous = vertex;
+        faceVertexCount++;
+    }
+
+    return p;
+}
+
+// OBJ indices are 1-based, negative ones count back from the last attribute read
+static int32_t resolveObjIndex(long index, uint32_t count) {
+    long resolved = index < 0 ? (long)count + index : index - 1;
+    if (resolved < 0 || resolved >= (long)count) {
+        THROW("OBJ face references a missing vertex attribute");
+    }
+    return (int32_t)resolved;
+}
+
+// Returns the index of the vertex with this position/uv/normal combination, adding it if it's new
+static uint32_t emitVertex(ObjParser *parser, ObjVertexKey key) {
+    MeshData *mesh = parser->mesh;
+
+    uint32_t mask = parser->vertexTableSize - 1;
+    uint32_t bucket = hashVertexKey(key) & mask;
+    while (parser->pVertexTable[bucket] != UINT32_MAX) {
+        const ObjVertexKey *existing = &parser->pVertexKeys[parser->pVertexTable[bucket]];
+        if (existing->position == key.position && existing->uv == key.uv && existing->normal == key.normal)
+            return parser->pVertexTable[bucket];
+        bucket = (bucket + 1) & mask;
+    }
+
+    // Vertices and their keys share a capacity, so they always grow together
+    uint32_t capacity = parser->vertexCapacity;
+    mesh->pVertices = growArray(mesh->pVertices, &capacity, mesh->vertexCount, sizeof(Vertex));
+    parser->pVertexKeys = growArray(parser->pVertexKeys, &parser->vertexCapacity, mesh->vertexCount, sizeof(ObjVertexKey));
+
+    uint32_t index = mesh->vertexCount++;
+    parser->pVertexKeys[index] = key;
+    parser->pVertexTable[bucket] = index;
+
+    Vertex *vertex = &mesh->pVertices[index];
+    memset(vertex, 0, sizeof(Vertex));
+    memcpy(vertex->position, parser->pPositions[key.position], sizeof(vertex->position));
+    if (key.normal >= 0) {
+        memcpy(vertex->normal, parser->pNormals[key.normal], sizeof(vertex->normal));
+    }
+    if (key.uv >= 0) {
+        memcpy(vertex->uv, parser->pUvs[key.uv], sizeof(vertex->uv));
+    }
+
+    if (mesh->vertexCount * 2 > parser->vertexTableSize) {
+        rehashVertices(parser);
+    }
+    return index;
+}
+
+static uint32_t hashVertexKey(ObjVertexKey key) {
+    uint32_t hash = 2166136261u; // FNV-1a over the three indices
+    const int32_t parts[3] = { key.position, key.uv, key.normal };
+    for (uint32_t i = 0; i < 3; i++) {
+        hash = (hash ^ (uint32_t)parts[i]) * 16777619u;
+    }
+    return hash ^ (hash >> 15);
+}
+
+// Doubles the hash table (or creates it) and reinserts every vertex
+static void rehashVertices(ObjParser *parser) {
+    parser->vertexTableSize = parser->vertexTableSize ? parser->vertexTableSize * 2 : 4096;
+    free(parser->pVertexTable);
+    parser->pVertexTable = (uint32_t *)malloc(parser->vertexTableSize * sizeof(uint32_t));
+    if (!parser->pVertexTable) {
+        THROW("malloc fail in rehashVertices");
+    }
+    memset(parser->pVertexTable, 0xFF, parser->vertexTableSize * sizeof(uint32_t));
+
+    uint32_t mask = parser->vertexTableSize - 1;
+    for (uint32_t i = 0; i < parser->mesh->vertexCount; i++) {
+        uint32_t bucket = hashVertexKey(parser->pVertexKeys[i]) & mask;
+        while (parser->pVertexTable[bucket] != UINT32_MAX) {
+            bucket = (bucket + 1) & mask;
+        }
+        parser->pVertexTable[bucket] = i;
+    }
+}
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
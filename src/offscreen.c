@@ -0,0 +1,67 @@
+#include <buffers.h>
+#include <offscreen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <utils.h>
+
+void app_CreateOffscreenTargets(App *app) {
+    app->swapChainImageCount = OFFSCREEN_IMAGE_COUNT;
+    app->swapChainImageFormat = OFFSCREEN_IMAGE_FORMAT;
+    app->swapChainExtent.width = WIDTH;
+    app->swapChainExtent.height = HEIGHT;
+
+    app->pSwapChainImages = (VkImage *)calloc(OFFSCREEN_IMAGE_COUNT, sizeof(VkImage));
+    app->pOffscreenImageMemory = (VkDeviceMemory *)calloc(OFFSCREEN_IMAGE_COUNT, sizeof(VkDeviceMemory));
+    if (!app->pSwapChainImages || !app->pOffscreenImageMemory) {
+        THROW("malloc fail in app_CreateOffscreenTargets");
+    }
+
+    for (uint32_t i = 0; i < OFFSCREEN_IMAGE_COUNT; i++) {
+        VkImageCreateInfo imageInfo = {0};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = OFFSCREEN_IMAGE_FORMAT;
+        imageInfo.extent.width = app->swapChainExtent.width;
+        imageInfo.extent.height = app->swapChainExtent.height;
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(app->device, &imageInfo, NULL, &app->pSwapChainImages[i]) != VK_SUCCESS) {
+            THROW("Failed to create offscreen image!");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(app->device, app->pSwapChainImages[i], &memRequirements);
+
+        VkMemoryAllocateInfo allocInfo = {0};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = memRequirements.size;
+        allocInfo.memoryTypeIndex = findMemoryType(app->physicalDevice, memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if (vkAllocateMemory(app->device, &allocInfo, NULL, &app->pOffscreenImageMemory[i]) != VK_SUCCESS) {
+            THROW("Failed to allocate offscreen image memory!");
+        }
+
+        vkBindImageMemory(app->device, app->pSwapChainImages[i], app->pOffscreenImageMemory[i], 0);
+    }
+}
+
+void app_DestroyOffscreenTargets(App *app) {
+    for (uint32_t i = 0; i < app->swapChainImageCount; i++) {
+        if (app->pSwapChainImages && app->pSwapChainImages[i]) {
+            vkDestroyImage(app->device, app->pSwapChainImages[i], NULL);
+        }
+        if (app->pOffscreenImageMemory && app->pOffscreenImageMemory[i]) {
+            vkFreeMemory(app->device, app->pOffscreenImageMemory[i], NULL);
+        }
+    }
+
+    free(app->pOffscreenImageMemory);
+    app->pOffscreenImageMemory = NULL;
+}
@@ -0,0 +1,291 @@
+#include <buffers.h>
+#include <readback.h>
+#include <stdlib.h>
+#include <utils.h>
+
+static uint32_t formatPixelSize(VkFormat format);
+static void createSlot(App *app, Readback *readback, ReadbackSlot *slot);
+static void *writerThreadMain(void *pArg);
+
+Readback *readback_Create(App *app, const char *fileName) {
+    // The swap chain format falls back to whatever the surface offers first, which may be a wider one
+    if (formatPixelSize(app->swapChainImageFormat) != 4) {
+        fprintf(stderr, "Swap chain format (VkFormat %d) isn't 4 bytes per pixel, frame capture disabled.\n", app->swapChainImageFormat);
+        app->captureFileName = NULL;
+        return NULL;
+    }
+
+    Readback *readback = (Readback *)calloc(1, sizeof(Readback));
+    if (!readback) {
+        THROW("malloc fail in readback_Create");
+    }
+
+    readback->file = fopen(fileName, "wb");
+    if (!readback->file) {
+        THROW("Failed to open capture file");
+    }
+
+    readback->extent = app->swapChainExtent;
+    readback->frameSize = (VkDeviceSize)readback->extent.width * readback->extent.height * 4;
+
+    for (uint32_t i = 0; i < READBACK_SLOT_COUNT; i++) {
+        createSlot(app, readback, &readback->slots[i]);
+    }
+
+    pthread_mutex_init(&readback->mutex, NULL);
+    pthread_cond_init(&readback->wake, NULL);
+    if (pthread_create(&readback->writerThread, NULL, writerThreadMain, readback) != 0) {
+        THROW("Failed to start capture writer thread");
+    }
+
+    fprintf(stderr, "Capturing %ux%u frames (VkFormat %d, raw) to %s\n",
+            readback->extent.width, readback->extent.height, app->swapChainImageFormat, fileName);
+
+    return readback;
+}
+
+void readback_RecordCopy(Readback *readback, App *app, VkCommandBuffer commandBuffer, uint32_t imageIndex, uint64_t frameNumber) {
+    ReadbackSlot *slot = &readback->slots[readback->nextCopySlot];
+    bool sameExtent = app->swapChainExtent.width == readback->extent.width && app->swapChainExtent.height == readback->extent.height;
+
+    pthread_mutex_lock(&readback->mutex);
+    if (readback->writeFailed) {
+        pthread_mutex_unlock(&readback->mutex);
+        return;
+    }
+    bool slotFree = sameExtent && slot->state == READBACK_SLOT_FREE;
+    if (slotFree) {
+        slot->state = READBACK_SLOT_IN_FLIGHT;
+        slot->frameNumber = frameNumber;
+    } else {
+        readback->framesDropped++;
+    }
+    pthread_mutex_unlock(&readback->mutex);
+
+    // Dropping is preferable to waiting on the writer: capture must never slow down rendering
+    if (!slotFree)
+        return;
+
+    readback->nextCopySlot = (readback->nextCopySlot + 1) % READBACK_SLOT_COUNT;
+
+    // The render pass leaves swap chain images ready for presentation (offscreen ones ready for transfer)
+    const VkImageLayout finalLayout = app->headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    VkImageMemoryBarrier toTransfer = {0};
+    toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    toTransfer.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    toTransfer.oldLayout = finalLayout;
+    toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.image = app->pSwapChainImages[imageIndex];
+    toTransfer.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    toTransfer.subresourceRange.baseMipLevel = 0;
+    toTransfer.subresourceRange.levelCount = 1;
+    toTransfer.subresourceRange.baseArrayLayer = 0;
+    toTransfer.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+            0, NULL, 0, NULL, 1, &toTransfer);
+
+    VkBufferImageCopy region = {0};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0; // Tightly packed
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent.width = readback->extent.width;
+    region.imageExtent.height = readback->extent.height;
+    region.imageExtent.depth = 1;
+
+    vkCmdCopyImageToBuffer(commandBuffer, toTransfer.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot->buffer, 1, &region);
+
+    VkBufferMemoryBarrier toHost = {0};
+    toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toHost.buffer = slot->buffer;
+    toHost.offset = 0;
+    toHost.size = VK_WHOLE_SIZE;
+
+    VkImageMemoryBarrier toFinal = toTransfer;
+    toFinal.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    toFinal.dstAccessMask = 0;
+    toFinal.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    toFinal.newLayout = finalLayout;
+
+    vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+            0, NULL, 1, &toHost, 1, &toFinal);
+}
+
+void readback_Collect(Readback *readback, VkDevice device, uint64_t completedFrames) {
+    for (;;) {
+        ReadbackSlot *slot = &readback->slots[readback->nextCollectSlot];
+
+        pthread_mutex_lock(&readback->mutex);
+        bool ready = slot->state == READBACK_SLOT_IN_FLIGHT && slot->frameNumber < completedFrames;
+        pthread_mutex_unlock(&readback->mutex);
+        if (!ready)
+            break;
+
+        if (!readback->hostCoherent) {
+            VkMappedMemoryRange range = {0};
+            range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+            range.memory = slot->memory;
+            range.offset = 0;
+            range.size = VK_WHOLE_SIZE;
+            vkInvalidateMappedMemoryRanges(device, 1, &range);
+        }
+
+        pthread_mutex_lock(&readback->mutex);
+        slot->state = READBACK_SLOT_QUEUED;
+        readback->queue[(readback->queueHead + readback->queueCount) % READBACK_SLOT_COUNT] = readback->nextCollectSlot;
+        readback->queueCount++;
+        pthread_cond_signal(&readback->wake);
+        pthread_mutex_unlock(&readback->mutex);
+
+        readback->nextCollectSlot = (readback->nextCollectSlot + 1) % READBACK_SLOT_COUNT;
+    }
+}
+
+void readback_Destroy(Readback *readback, VkDevice device) {
+    if (!readback)
+        return;
+
+    readback_Collect(readback, device, UINT64_MAX);
+
+    pthread_mutex_lock(&readback->mutex);
+    readback->stopping = true;
+    pthread_cond_signal(&readback->wake);
+    pthread_mutex_unlock(&readback->mutex);
+    pthread_join(readback->writerThread, NULL);
+
+    if (fclose(readback->file) != 0) {
+        readback->writeFailed = true;
+    }
+
+    fprintf(stderr, "Captured %lu frames (%lu dropped), %lu bytes written%s\n",
+            (unsigned long)readback->framesCaptured, (unsigned long)readback->framesDropped, (unsigned long)readback->bytesWritten,
+            readback->writeFailed ? ", capture stopped early: writing to the file failed" : "");
+
+    for (uint32_t i = 0; i < READBACK_SLOT_COUNT; i++) {
+        vkUnmapMemory(device, readback->slots[i].memory);
+        vkDestroyBuffer(device, readback->slots[i].buffer, NULL);
+        vkFreeMemory(device, readback->slots[i].memory, NULL);
+    }
+
+    pthread_cond_destroy(&readback->wake);
+    pthread_mutex_destroy(&readback->mutex);
+    free(readback);
+}
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+// 4 for the 8-bit and 10-bit-per-channel formats a swap chain or the offscreen targets usually end up with, 0 for any other
+static uint32_t formatPixelSize(VkFormat format) {
+    switch (format) {
+    case VK_FORMAT_B8G8R8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+    case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+    case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+    case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+static void createSlot(App *app, Readback *readback, ReadbackSlot *slot) {
+    VkBufferCreateInfo bufferInfo = {0};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = readback->frameSize;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(app->device, &bufferInfo, NULL, &slot->buffer) != VK_SUCCESS) {
+        THROW("Failed to create readback buffer!");
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(app->device, slot->buffer, &memRequirements);
+
+    // CPU reads from uncached (write-combined) memory are very slow, so prefer cached memory and invalidate by hand
+    OptionalUint32 memoryType = queryMemoryType(app->physicalDevice, memRequirements.memoryTypeBits,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    readback->hostCoherent = false;
+    if (!memoryType.hasValue) {
+        memoryType.value = findMemoryType(app->physicalDevice, memRequirements.memoryTypeBits,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        readback->hostCoherent = true;
+    }
+
+    VkMemoryAllocateInfo allocInfo = {0};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memRequirements.size;
+    allocInfo.memoryTypeIndex = memoryType.value;
+
+    if (vkAllocateMemory(app->device, &allocInfo, NULL, &slot->memory) != VK_SUCCESS) {
+        THROW("Failed to allocate readback buffer memory!");
+    }
+
+    vkBindBufferMemory(app->device, slot->buffer, slot->memory, 0);
+
+    if (vkMapMemory(app->device, slot->memory, 0, VK_WHOLE_SIZE, 0, &slot->pMapped) != VK_SUCCESS) {
+        THROW("Failed to map readback buffer memory!");
+    }
+
+    slot->state = READBACK_SLOT_FREE;
+}
+
+static void *writerThreadMain(void *pArg) {
+    Readback *readback = (Readback *)pArg;
+
+    pthread_mutex_lock(&readback->mutex);
+    for (;;) {
+        while (readback->queueCount == 0 && !readback->stopping) {
+            pthread_cond_wait(&readback->wake, &readback->mutex);
+        }
+        if (readback->queueCount == 0)
+            break;
+
+        uint32_t slotIndex = readback->queue[readback->queueHead];
+        readback->queueHead = (readback->queueHead + 1) % READBACK_SLOT_COUNT;
+        readback->queueCount--;
+        pthread_mutex_unlock(&readback->mutex);
+
+        // The slot stays QUEUED while it's written, so the render thread won't reuse it underneath us. Once a write
+        // failed (disk full, closed pipe) the rest of the queue is discarded: a frame with a gap would shift every
+        // frame after it.
+        bool failed = readback->writeFailed;
+        size_t written = 0;
+        if (!failed) {
+            written = fwrite(readback->slots[slotIndex].pMapped, 1, readback->frameSize, readback->file);
+            if (written != readback->frameSize) {
+                perror("Frame capture write failed, capture stopped");
+                failed = true;
+            }
+        }
+
+        pthread_mutex_lock(&readback->mutex);
+        readback->bytesWritten += written;
+        if (failed) {
+            readback->writeFailed = true;
+        } else {
+            readback->framesCaptured++;
+        }
+        readback->slots[slotIndex].state = READBACK_SLOT_FREE;
+    }
+    pthread_mutex_unlock(&readback->mutex);
+
+    return NULL;
+}
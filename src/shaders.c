@@ -2,7 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <utils.h>
-#include <vulkan/vulkan_core.h>
+#include <vk_loader.h>
 
 uint32_t *readShaderSource(char *fileName, size_t *outSize) {
     FILE *file = fopen(fileName, "rb");
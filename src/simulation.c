@@ -0,0 +1,177 @@
+#include <simulation.h>
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <utils.h>
+
+// Triple buffer slot indices are 0-2, this bit marks the middle slot as holding a snapshot not yet picked up
+#define SIMULATION_SLOT_FRESH 4u
+#define SIMULATION_SLOT_MASK 3u
+
+static void *simulationThreadMain(void *pArg);
+static void stepObjects(Simulation *simulation, float dt);
+static void writeSnapshot(Simulation *simulation, SceneSnapshot *snapshot, uint64_t tick);
+static void sleepUntilNs(uint64_t deadlineNs);
+
+Simulation *simulation_Create(App *app, uint32_t tickHz) {
+    if (tickHz == 0 || tickHz > SIMULATION_MAX_HZ) {
+        THROW("simulation_Create: tick rate out of range");
+    }
+
+    // The hot fields sit on their own cache lines, which takes an aligned allocation
+    Simulation *simulation = (Simulation *)aligned_alloc(alignof(Simulation), sizeof(Simulation));
+    if (!simulation) {
+        THROW("malloc fail in simulation_Create");
+    }
+    memset(simulation, 0, sizeof(Simulation));
+
+    simulation->app = app;
+    simulation->tickHz = tickHz;
+    simulation->tickNs = 1000000000ull / tickHz;
+
+    // Objects orbiting the center at different radii and speeds, alternating direction
+    for (uint32_t i = 0; i < SIMULATION_OBJECT_COUNT; i++) {
+        SimulationObject *object = &simulation->objects[i];
+        object->angle = 2.0f * (float)M_PI * (float)i / SIMULATION_OBJECT_COUNT;
+        object->angularVelocity = (i % 2 ? -1.0f : 1.0f) * (0.4f + 0.1f * (float)(i % 5));
+        object->radius = 0.2f + 0.2f * (float)(i % 4);
+        object->scale = 0.08f;
+    }
+
+    // Tick 0 is in the front slot before the thread starts, so the renderer always has a snapshot
+    simulation->startNs = timeNowNs();
+    writeSnapshot(simulation, &simulation->slots[0], 0);
+    simulation->front = 0;
+    atomic_init(&simulation->middle, 1);
+    simulation->back = 2;
+    atomic_init(&simulation->stopping, false);
+
+    if (pthread_create(&simulation->thread, NULL, simulationThreadMain, simulation) != 0) {
+        THROW("Failed to start simulation thread");
+    }
+
+    return simulation;
+}
+
+void simulation_Destroy(Simulation *simulation) {
+    if (!simulation)
+        return;
+
+    atomic_store(&simulation->stopping, true);
+    pthread_join(simulation->thread, NULL);
+
+    fprintf(stderr, "Simulation: %lu ticks at %u Hz (%lu skipped), %.3f ms per step\n",
+            (unsigned long)simulation->ticks, simulation->tickHz, (unsigned long)simulation->skippedTicks,
+            simulation->ticks ? (double)simulation->stepTotalNs / 1e6 / (double)simulation->ticks : 0.0);
+
+    free(simulation);
+}
+
+void simulation_Interpolate(Simulation *simulation, uint64_t nowNs, PushConstants transforms[SIMULATION_OBJECT_COUNT]) {
+    if (atomic_load_explicit(&simulation->middle, memory_order_relaxed) & SIMULATION_SLOT_FRESH) {
+        unsigned newest = atomic_exchange_explicit(&simulation->middle, simulation->front, memory_order_acq_rel);
+        simulation->front = newest & SIMULATION_SLOT_MASK;
+    }
+
+    const SceneSnapshot *current = &simulation->slots[simulation->front];
+
+    // Tick N is published at its own time, so one tick back it's always between tick N-1 and tick N
+    const uint64_t renderTimeNs = nowNs > simulation->tickNs ? nowNs - simulation->tickNs : 0;
+    float alpha = 1.0f;
+    if (current->simTimeNs > current->previousSimTimeNs) {
+        if (renderTimeNs <= current->previousSimTimeNs) {
+            alpha = 0.0f;
+        } else if (renderTimeNs < current->simTimeNs) {
+            alpha = (float)(renderTimeNs - current->previousSimTimeNs) / (float)(current->simTimeNs - current->previousSimTimeNs);
+        }
+    }
+
+    for (uint32_t i = 0; i < SIMULATION_OBJECT_COUNT; i++) {
+        const PushConstants *from = &current->previousTransforms[i];
+        const PushConstants *to = &current->transforms[i];
+        transforms[i].offset[0] = from->offset[0] + (to->offset[0] - from->offset[0]) * alpha;
+        transforms[i].offset[1] = from->offset[1] + (to->offset[1] - from->offset[1]) * alpha;
+        transforms[i].scale = from->scale + (to->scale - from->scale) * alpha;
+    }
+}
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+static void *simulationThreadMain(void *pArg) {
+    Simulation *simulation = (Simulation *)pArg;
+    const float dt = 1.0f / (float)simulation->tickHz;
+    uint64_t tick = 0;
+
+    while (!atomic_load_explicit(&simulation->stopping, memory_order_relaxed)) {
+        tick++;
+        uint64_t tickTimeNs = simulation->startNs + tick * simulation->tickNs;
+
+        uint64_t nowNs = timeNowNs();
+        if (nowNs > tickTimeNs + SIMULATION_MAX_CATCHUP_TICKS * simulation->tickNs) {
+            uint64_t behind = (nowNs - tickTimeNs) / simulation->tickNs;
+            simulation->skippedTicks += behind;
+            tick += behind;
+            tickTimeNs += behind * simulation->tickNs;
+        }
+
+        uint64_t stepStartNs = timeNowNs();
+        stepObjects(simulation, dt);
+        writeSnapshot(simulation, &simulation->slots[simulation->back], tick);
+        simulation->stepTotalNs += timeNowNs() - stepStartNs;
+        simulation->ticks++;
+
+        // Computed ahead, published when it's due
+        sleepUntilNs(tickTimeNs);
+
+        // Release the snapshot, and take back whichever slot the render thread last let go of
+        unsigned released = atomic_exchange_explicit(&simulation->middle, simulation->back | SIMULATION_SLOT_FRESH, memory_order_acq_rel);
+        simulation->back = released & SIMULATION_SLOT_MASK;
+
+        if (simulation->app->onDemand) {
+            app_MarkDirty(simulation->app);
+        }
+    }
+
+    return NULL;
+}
+
+static void stepObjects(Simulation *simulation, float dt) {
+    for (uint32_t i = 0; i < SIMULATION_OBJECT_COUNT; i++) {
+        SimulationObject *object = &simulation->objects[i];
+        object->angle = fmodf(object->angle + object->angularVelocity * dt, 2.0f * (float)M_PI);
+    }
+}
+
+// Writes the current step along with the last one written (itself for tick 0), then remembers it for the next
+static void writeSnapshot(Simulation *simulation, SceneSnapshot *snapshot, uint64_t tick) {
+    snapshot->tick = tick;
+    snapshot->simTimeNs = simulation->startNs + tick * simulation->tickNs;
+    for (uint32_t i = 0; i < SIMULATION_OBJECT_COUNT; i++) {
+        const SimulationObject *object = &simulation->objects[i];
+        snapshot->transforms[i].offset[0] = object->radius * cosf(object->angle);
+        snapshot->transforms[i].offset[1] = object->radius * sinf(object->angle);
+        snapshot->transforms[i].scale = object->scale;
+    }
+
+    if (tick == 0) {
+        simulation->lastSimTimeNs = snapshot->simTimeNs;
+        memcpy(simulation->lastTransforms, snapshot->transforms, sizeof(simulation->lastTransforms));
+    }
+    snapshot->previousSimTimeNs = simulation->lastSimTimeNs;
+    memcpy(snapshot->previousTransforms, simulation->lastTransforms, sizeof(snapshot->previousTransforms));
+
+    simulation->lastSimTimeNs = snapshot->simTimeNs;
+    memcpy(simulation->lastTransforms, snapshot->transforms, sizeof(simulation->lastTransforms));
+}
+
+static void sleepUntilNs(uint64_t deadlineNs) {
+    struct timespec deadline;
+    deadline.tv_sec = (time_t)(deadlineNs / 1000000000ull);
+    deadline.tv_nsec = (long)(deadlineNs % 1000000000ull);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+    }
+}
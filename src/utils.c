@@ -1,4 +1,5 @@
 #include <utils.h>
+#include <time.h>
 
 uint32_t clamp(uint32_t value, uint32_t min, uint32_t max) {
     if (value < min)
@@ -7,3 +8,15 @@ uint32_t clamp(uint32_t value, uint32_t min, uint32_t max) {
         return max;
     return value;
 }
+
+uint64_t timeNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t cpuTimeNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include <validation_layers.h>
 
 #ifdef NDEBUG
@@ -24,6 +25,30 @@ const char **getValidationLayers() {
     return valLayers;
 }
 
+bool checkValidationLayerSupport() {
+    uint32_t layerCount;
+    vkEnumerateInstanceLayerProperties(&layerCount, NULL);
+    if (layerCount == 0)
+        return false;
+
+    VkLayerProperties availableLayers[layerCount];
+    vkEnumerateInstanceLayerProperties(&layerCount, availableLayers);
+
+    for (uint32_t i = 0; i < VALIDATION_LAYERS_COUNT; i++) {
+        bool layerFound = false;
+        for (uint32_t j = 0; j < layerCount; j++) {
+            if (strcmp(valLayers[i], availableLayers[j].layerName) == 0) {
+                layerFound = true;
+                break;
+            }
+        }
+        if (!layerFound)
+            return false;
+    }
+
+    return true;
+}
+
 void vkDebugMessengerCreateInfo_Populate(VkDebugUtilsMessengerCreateInfoEXT *pCreateInfo) {
     (*pCreateInfo).sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
 
@@ -14,30 +14,48 @@ const char *deviceExtensions[DEVICE_EXTENSION_COUNT] = { VK_KHR_SWAPCHAIN_EXTENS
 
 static bool queueFamilyIndiciesIsComplete(struct QueueFamilyIndicies inicies);
 static bool checkDeviceExtensionSupport(VkPhysicalDevice device);
-static bool isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface);
-static const char **getRequiredExtensions(uint32_t *extensionCount);
+static bool isDeviceExtensionAvailable(VkPhysicalDevice device, const char *extensionName);
+static bool isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface, uint32_t instanceApiVersion);
+static uint32_t negotiateInstanceVersion(void);
+static DeviceFeatures queryDeviceFeatures(VkPhysicalDevice device, uint32_t instanceApiVersion);
+static const char **getRequiredExtensions(bool headless, bool validationEnabled, uint32_t *extensionCount);
 
 void app_CreateVkInstance(App *app) {
+    if (!vkLoader_Init()) {
+        THROW("Failed to load the Vulkan loader (libvulkan.so.1)");
+    }
+
+    app->apiVersion = negotiateInstanceVersion();
+    if (app->apiVersion < APP_MIN_API_VERSION) {
+        THROW("Vulkan 1.2 or newer is required");
+    }
+
     VkApplicationInfo appInfo = {0};
     appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
     appInfo.pApplicationName = "Hello Triangle";
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    appInfo.apiVersion = app->apiVersion;
 
     VkInstanceCreateInfo createInfo = {0};
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     createInfo.pApplicationInfo = &appInfo;
 
+    // Headless machines (e.g. CI running lavapipe) usually don't ship the validation layers
+    app->validationEnabled = enableValidationLayers && !app->disableValidation && checkValidationLayerSupport();
+    if (enableValidationLayers && !app->disableValidation && !app->validationEnabled) {
+        fprintf(stderr, "Validation layers requested, but not available. Continuing without them.\n");
+    }
+
     uint32_t extensionCount = 0;
-    const char **extensions = getRequiredExtensions(&extensionCount);
+    const char **extensions = getRequiredExtensions(app->headless, app->validationEnabled, &extensionCount);
     createInfo.enabledExtensionCount = extensionCount;
     createInfo.ppEnabledExtensionNames = extensions;
 
     // Validation Layers
     VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo = {0};
-    if (enableValidationLayers) {
+    if (app->validationEnabled) {
         createInfo.enabledLayerCount = (uint32_t)VALIDATION_LAYERS_COUNT;
         createInfo.ppEnabledLayerNames = getValidationLayers();
 
@@ -48,13 +66,17 @@ void app_CreateVkInstance(App *app) {
         createInfo.pNext = NULL;
     }
 
-    if (vkCreateInstance(&createInfo, NULL, &app->instance) != VK_SUCCESS) {
+    VkResult result = vkCreateInstance(&createInfo, NULL, &app->instance);
+    free(extensions);
+    if (result != VK_SUCCESS) {
         THROW("Failed to create VkInstance");
     }
+
+    vkLoader_LoadInstance(app->instance);
 }
 
 void app_SetupDebugMessenger(App *app) {
-    if (!enableValidationLayers) return;
+    if (!app->validationEnabled) return;
 
     VkDebugUtilsMessengerCreateInfoEXT createInfo = {0};
     vkDebugMessengerCreateInfo_Populate(&createInfo);
@@ -81,7 +103,7 @@ void app_PickPhysicalDevice(App *app) {
     vkEnumeratePhysicalDevices(app->instance, &deviceCount, devices);
     
     for (uint32_t i = 0; i < deviceCount; i++) {
-        if (isDeviceSuitable(devices[i], app->surface)) {
+        if (isDeviceSuitable(devices[i], app->surface, app->apiVersion)) {
             app->physicalDevice = devices[i];
             break;
         }
@@ -91,6 +113,9 @@ void app_PickPhysicalDevice(App *app) {
         THROW("Failed to find a suitable GPU");
     }
 
+    app->deviceFeatures = queryDeviceFeatures(app->physicalDevice, app->apiVersion);
+    // Nothing is presented when headless
+    app->deviceFeatures.presentWait = app->deviceFeatures.presentWait && !app->headless;
 }
 
 void app_CreateLogicalDevice(App *app) {
@@ -116,19 +141,62 @@ void app_CreateLogicalDevice(App *app) {
         queueCreateInfos[i] = queueCreateInfo;
     }
 
-    VkPhysicalDeviceFeatures deviceFeatures = {0};
+    // Only enable what was negotiated in app_PickPhysicalDevice, some of these have a cost when on
+    const DeviceFeatures *negotiated = &app->deviceFeatures;
+
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {0};
+    presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    presentWaitFeatures.presentWait = VK_TRUE;
+
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {0};
+    presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    presentIdFeatures.pNext = &presentWaitFeatures;
+    presentIdFeatures.presentId = VK_TRUE;
+
+    VkPhysicalDeviceVulkan13Features features13 = {0};
+    features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    features13.pNext = negotiated->presentWait ? &presentIdFeatures : NULL;
+    features13.synchronization2 = negotiated->synchronization2;
+
+    VkPhysicalDeviceVulkan12Features features12 = {0};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features12.pNext = negotiated->apiVersion >= VK_API_VERSION_1_3 ? (void *)&features13 : (negotiated->presentWait ? (void *)&presentIdFeatures : NULL);
+    features12.timelineSemaphore = VK_TRUE;
+    features12.bufferDeviceAddress = negotiated->bufferDeviceAddress;
+    features12.descriptorIndexing = negotiated->descriptorIndexing;
+    features12.runtimeDescriptorArray = negotiated->descriptorIndexing;
+    features12.descriptorBindingPartiallyBound = negotiated->descriptorIndexing;
+    features12.shaderSampledImageArrayNonUniformIndexing = negotiated->descriptorIndexing;
+
+    VkPhysicalDeviceFeatures2 deviceFeatures = {0};
+    deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    deviceFeatures.pNext = &features12;
 
     VkDeviceCreateInfo createInfo = {0};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &deviceFeatures;
     createInfo.pQueueCreateInfos = queueCreateInfos;
     createInfo.queueCreateInfoCount = uniqueQueueFamiliesCount;
 
-    createInfo.pEnabledFeatures = &deviceFeatures;
+    // Core features go through deviceFeatures.features when a VkPhysicalDeviceFeatures2 is chained
+    createInfo.pEnabledFeatures = NULL;
 
-    createInfo.enabledExtensionCount = DEVICE_EXTENSION_COUNT;
-    createInfo.ppEnabledExtensionNames = deviceExtensions;
+    // Offscreen rendering doesn't present, so it doesn't need the swap chain extension
+    const char *enabledExtensions[DEVICE_EXTENSION_COUNT + 2];
+    uint32_t enabledExtensionCount = 0;
+    if (!app->headless) {
+        for (uint32_t i = 0; i < DEVICE_EXTENSION_COUNT; i++) {
+            enabledExtensions[enabledExtensionCount++] = deviceExtensions[i];
+        }
+    }
+    if (negotiated->presentWait) {
+        enabledExtensions[enabledExtensionCount++] = VK_KHR_PRESENT_ID_EXTENSION_NAME;
+        enabledExtensions[enabledExtensionCount++] = VK_KHR_PRESENT_WAIT_EXTENSION_NAME;
+    }
+    createInfo.enabledExtensionCount = enabledExtensionCount;
+    createInfo.ppEnabledExtensionNames = enabledExtensionCount ? enabledExtensions : NULL;
 
-    if (enableValidationLayers) {
+    if (app->validationEnabled) {
         createInfo.enabledLayerCount = (uint32_t)VALIDATION_LAYERS_COUNT;
         createInfo.ppEnabledLayerNames = getValidationLayers();
     } else {
@@ -139,6 +207,11 @@ void app_CreateLogicalDevice(App *app) {
         THROW("failed to create logical device!");
     }
 
+    // From here on, device functions call into the driver without going through the loader
+    if (!vkLoader_LoadDevice(app->device, &app->dispatch)) {
+        THROW("Another Vulkan device is still loaded, only one can be live at a time");
+    }
+
     vkGetDeviceQueue(app->device, indicies.graphicsFamily.value, 0, &app->graphicsQueue);
     vkGetDeviceQueue(app->device, indicies.presentFamily.value, 0, &app->presentQueue);
 }
@@ -164,8 +237,13 @@ struct QueueFamilyIndicies findQueueFamilies(VkPhysicalDevice device, VkSurfaceK
             indicies.graphicsFamily.hasValue = true;
         }
 
+        // Without a surface (headless) nothing is presented, so any graphics queue will do
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        if (surface == VK_NULL_HANDLE) {
+            presentSupport = (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        } else {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        }
         if (presentSupport) {
             indicies.presentFamily.value = i;
             indicies.presentFamily.hasValue = true;
@@ -198,9 +276,18 @@ static bool checkDeviceExtensionSupport(VkPhysicalDevice device) {
     return foundRequiredExtensionsCount == DEVICE_EXTENSION_COUNT;
 }
 
-static bool isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface) {
+static bool isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface, uint32_t instanceApiVersion) {
+    // Frame synchronization is built on timeline semaphores, there is no fence fallback
+    if (!queryDeviceFeatures(device, instanceApiVersion).timelineSemaphore) {
+        return false;
+    }
+
     struct QueueFamilyIndicies indicies = findQueueFamilies(device, surface);
 
+    if (surface == VK_NULL_HANDLE) {
+        return queueFamilyIndiciesIsComplete(indicies);
+    }
+
     bool extensionsSupported = checkDeviceExtensionSupport(device);
 
     bool swapChainAdequate = false;
@@ -212,13 +299,16 @@ static bool isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface) {
     return queueFamilyIndiciesIsComplete(indicies) && extensionsSupported && swapChainAdequate;
 }
 
-static const char **getRequiredExtensions(uint32_t *extensionCount) {
+static const char **getRequiredExtensions(bool headless, bool validationEnabled, uint32_t *extensionCount) {
     uint32_t glfwExtensionCount = 0;
-    const char **glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    const char **glfwExtensions = NULL;
+    if (!headless) {
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    }
 
     *extensionCount = glfwExtensionCount;
-    const char **extensions = (const char **)malloc(glfwExtensionCount * sizeof(const char *));
+    // Room for the debug utils extension too, and never a zero sized allocation when headless
+    const char **extensions = (const char **)malloc((glfwExtensionCount + 1) * sizeof(const char *));
     if (!extensions) {
         THROW("malloc fail: getRequiredExtensions");
     }
@@ -227,16 +317,85 @@ static const char **getRequiredExtensions(uint32_t *extensionCount) {
         extensions[i] = glfwExtensions[i];
     }
 
-    if (enableValidationLayers) {
-        const char **new_extensions = (const char **)realloc(extensions, (glfwExtensionCount + 1) *sizeof(const char *));
-        if (!new_extensions) {
-            free(extensions);
-            THROW("malloc fail: getRequiredExtensions");
-        }
-        extensions = new_extensions;
+    if (validationEnabled) {
         extensions[glfwExtensionCount] = VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
         (*extensionCount)++;
     }
 
 return extensions;
 }
+
+static uint32_t negotiateInstanceVersion(void) {
+    // vkEnumerateInstanceVersion doesn't exist in 1.0 loaders, vkLoader_Init leaves it NULL there
+    uint32_t version = VK_API_VERSION_1_0;
+    if (vkEnumerateInstanceVersion != NULL) {
+        vkEnumerateInstanceVersion(&version);
+    }
+
+    return version < APP_MAX_API_VERSION ? version : APP_MAX_API_VERSION;
+}
+
+static DeviceFeatures queryDeviceFeatures(VkPhysicalDevice device, uint32_t instanceApiVersion) {
+    DeviceFeatures features = {0};
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+    features.apiVersion = properties.apiVersion < instanceApiVersion ? properties.apiVersion : instanceApiVersion;
+    if (features.apiVersion < APP_MIN_API_VERSION) {
+        return features;
+    }
+
+    // Extension feature structs may only be chained when the extension exists
+    const bool presentWaitAvailable = isDeviceExtensionAvailable(device, VK_KHR_PRESENT_ID_EXTENSION_NAME)
+        && isDeviceExtensionAvailable(device, VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {0};
+    presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {0};
+    presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    presentIdFeatures.pNext = &presentWaitFeatures;
+
+    VkPhysicalDeviceVulkan13Features features13 = {0};
+    features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    features13.pNext = presentWaitAvailable ? &presentIdFeatures : NULL;
+
+    VkPhysicalDeviceVulkan12Features features12 = {0};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features12.pNext = features.apiVersion >= VK_API_VERSION_1_3 ? (void *)&features13 : (presentWaitAvailable ? (void *)&presentIdFeatures : NULL);
+
+    VkPhysicalDeviceFeatures2 features2 = {0};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &features12;
+
+    vkGetPhysicalDeviceFeatures2(device, &features2);
+
+    features.timelineSemaphore = features12.timelineSemaphore;
+    features.bufferDeviceAddress = features12.bufferDeviceAddress;
+    features.descriptorIndexing = features12.descriptorIndexing
+        && features12.runtimeDescriptorArray
+        && features12.descriptorBindingPartiallyBound
+        && features12.shaderSampledImageArrayNonUniformIndexing;
+    features.synchronization2 = features13.synchronization2;
+    features.presentWait = presentWaitAvailable && presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+
+    return features;
+}
+
+static bool isDeviceExtensionAvailable(VkPhysicalDevice device, const char *extensionName) {
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, NULL, &extensionCount, NULL);
+    if (extensionCount == 0)
+        return false;
+
+    VkExtensionProperties availableExtensions[extensionCount];
+    vkEnumerateDeviceExtensionProperties(device, NULL, &extensionCount, availableExtensions);
+
+    for (uint32_t i = 0; i < extensionCount; i++) {
+        if (strcmp(availableExtensions[i].extensionName, extensionName) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,92 @@
+#include <vk_loader.h>
+
+#include <dlfcn.h>
+#include <stddef.h>
+
+#define VK_LOADER_DEFINE_FUNCTION(name) PFN_##name name = NULL;
+PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr = NULL;
+VK_LOADER_GLOBAL_FUNCTIONS(VK_LOADER_DEFINE_FUNCTION)
+VK_LOADER_INSTANCE_FUNCTIONS(VK_LOADER_DEFINE_FUNCTION)
+VK_LOADER_DEVICE_FUNCTIONS(VK_LOADER_DEFINE_FUNCTION)
+#undef VK_LOADER_DEFINE_FUNCTION
+
+static void *loaderLibrary = NULL;
+static VkInstance loadedInstance = VK_NULL_HANDLE;
+static VkDevice loadedDevice = VK_NULL_HANDLE;
+
+static void loadDeviceTrampolines(void);
+
+bool vkLoader_Init(void) {
+    if (loaderLibrary)
+        return true;
+
+    loaderLibrary = dlopen("libvulkan.so.1", RTLD_NOW | RTLD_LOCAL);
+    if (!loaderLibrary) {
+        loaderLibrary = dlopen("libvulkan.so", RTLD_NOW | RTLD_LOCAL);
+    }
+    if (!loaderLibrary)
+        return false;
+
+    vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr)dlsym(loaderLibrary, "vkGetInstanceProcAddr");
+    if (!vkGetInstanceProcAddr) {
+        dlclose(loaderLibrary);
+        loaderLibrary = NULL;
+        return false;
+    }
+
+    // vkEnumerateInstanceVersion stays NULL with a Vulkan 1.0 loader
+#define VK_LOADER_LOAD_GLOBAL(name) name = (PFN_##name)vkGetInstanceProcAddr(NULL, #name);
+    VK_LOADER_GLOBAL_FUNCTIONS(VK_LOADER_LOAD_GLOBAL)
+#undef VK_LOADER_LOAD_GLOBAL
+
+    return true;
+}
+
+void vkLoader_LoadInstance(VkInstance instance) {
+    loadedInstance = instance;
+#define VK_LOADER_LOAD_INSTANCE(name) name = (PFN_##name)vkGetInstanceProcAddr(instance, #name);
+    VK_LOADER_INSTANCE_FUNCTIONS(VK_LOADER_LOAD_INSTANCE)
+#undef VK_LOADER_LOAD_INSTANCE
+
+    // A loaded device keeps its driver entry points
+    if (!loadedDevice) {
+        loadDeviceTrampolines();
+    }
+}
+
+void vkLoader_LoadDeviceDispatch(VkDevice device, DeviceDispatch *dispatch) {
+#define VK_LOADER_LOAD_DISPATCH(name) dispatch->name = (PFN_##name)vkGetDeviceProcAddr(device, #name);
+    VK_LOADER_DEVICE_FUNCTIONS(VK_LOADER_LOAD_DISPATCH)
+#undef VK_LOADER_LOAD_DISPATCH
+}
+
+bool vkLoader_LoadDevice(VkDevice device, DeviceDispatch *dispatch) {
+    if (loadedDevice && loadedDevice != device)
+        return false;
+
+    vkLoader_LoadDeviceDispatch(device, dispatch);
+    loadedDevice = device;
+
+#define VK_LOADER_LOAD_DEVICE(name) name = dispatch->name;
+    VK_LOADER_DEVICE_FUNCTIONS(VK_LOADER_LOAD_DEVICE)
+#undef VK_LOADER_LOAD_DEVICE
+
+    return true;
+}
+
+void vkLoader_UnloadDevice(VkDevice device) {
+    if (device != loadedDevice)
+        return;
+
+    loadedDevice = VK_NULL_HANDLE;
+    loadDeviceTrampolines();
+}
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+static void loadDeviceTrampolines(void) {
+    // Trampolines work with any device of the instance. Before any instance is loaded they are all NULL.
+#define VK_LOADER_LOAD_TRAMPOLINE(name) name = loadedInstance ? (PFN_##name)vkGetInstanceProcAddr(loadedInstance, #name) : NULL;
+    VK_LOADER_DEVICE_FUNCTIONS(VK_LOADER_LOAD_TRAMPOLINE)
+#undef VK_LOADER_LOAD_TRAMPOLINE
+}
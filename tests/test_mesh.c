@@ -0,0 +1,195 @@
+// CPU-only checks of the OBJ parser and the mesh cache: parsing, vertex deduplication, a cache round trip, and
+// meshCache_Open rejecting every kind of corrupted cache. Files are written to the working directory.
+
+#include <mesh.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+static int failures = 0;
+
+static void writeFile(const char *fileName, const void *data, size_t size);
+static void *readFile(const char *fileName, size_t *outSize);
+static bool opens(const char *fileName);
+static void checkCorrupted(const char *name, const uint8_t *cache, size_t cacheSize, void (*corrupt)(uint8_t *data, size_t *size));
+static void corruptMagic(uint8_t *data, size_t *size);
+static void corruptVersion(uint8_t *data, size_t *size);
+static void corruptStride(uint8_t *data, size_t *size);
+static void corruptAlignment(uint8_t *data, size_t *size);
+static void corruptTruncate(uint8_t *data, size_t *size);
+static void corruptTruncateHeader(uint8_t *data, size_t *size);
+static void corruptNoVertices(uint8_t *data, size_t *size);
+static void corruptNoIndices(uint8_t *data, size_t *size);
+static void corruptIndexRange(uint8_t *data, size_t *size);
+static void corruptIndexCount(uint8_t *data, size_t *size);
+
+int main(void) {
+    // A quad (triangulated as a fan) and a triangle reusing three of its corners, once with negative indices
+    const char *obj =
+        "# test mesh\n"
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+        "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+        "vn 0 0 1\n"
+        "g quad\n"
+        "f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+        "f -4/-4/-1 -2/-2/-1 -1/-1/-1\n";
+    writeFile("test_mesh.obj", obj, strlen(obj));
+
+    MeshData mesh;
+    mesh_LoadObj("test_mesh.obj", &mesh);
+    CHECK(mesh.vertexCount == 4);
+    CHECK(mesh.indexCount == 9);
+    const uint32_t expectedIndices[9] = { 0, 1, 2, 0, 2, 3, 0, 2, 3 };
+    CHECK(mesh.indexCount == 9 && memcmp(mesh.pIndices, expectedIndices, sizeof(expectedIndices)) == 0);
+    CHECK(mesh.vertexCount == 4 && mesh.pVertices[2].position[0] == 1.0f && mesh.pVertices[2].position[1] == 1.0f);
+    CHECK(mesh.vertexCount == 4 && mesh.pVertices[0].normal[2] == 1.0f);
+    // OBJ texture coordinates start at the bottom left, Vulkan's at the top left
+    CHECK(mesh.vertexCount == 4 && mesh.pVertices[0].uv[0] == 0.0f && mesh.pVertices[0].uv[1] == 1.0f);
+
+    meshCache_Write("test_mesh.vkmesh", &mesh);
+
+    MeshCache cache;
+    CHECK(meshCache_Open("test_mesh.vkmesh", &cache));
+    if (cache.pMapped) {
+        CHECK(cache.pHeader->vertexCount == mesh.vertexCount);
+        CHECK(cache.pHeader->indexCount == mesh.indexCount);
+        CHECK(memcmp(cache.pVertices, mesh.pVertices, mesh.vertexCount * sizeof(Vertex)) == 0);
+        CHECK(memcmp(cache.pIndices, mesh.pIndices, mesh.indexCount * sizeof(uint32_t)) == 0);
+        CHECK(cache.pHeader->boundsMin[0] == 0.0f && cache.pHeader->boundsMax[1] == 1.0f);
+        meshCache_Close(&cache);
+    }
+    CHECK(!opens("test_mesh_missing.vkmesh"));
+
+    size_t cacheSize;
+    uint8_t *cacheData = (uint8_t *)readFile("test_mesh.vkmesh", &cacheSize);
+    checkCorrupted("magic", cacheData, cacheSize, corruptMagic);
+    checkCorrupted("version", cacheData, cacheSize, corruptVersion);
+    checkCorrupted("stride", cacheData, cacheSize, corruptStride);
+    checkCorrupted("alignment", cacheData, cacheSize, corruptAlignment);
+    checkCorrupted("truncated", cacheData, cacheSize, corruptTruncate);
+    checkCorrupted("truncated header", cacheData, cacheSize, corruptTruncateHeader);
+    checkCorrupted("no vertices", cacheData, cacheSize, corruptNoVertices);
+    checkCorrupted("no indices", cacheData, cacheSize, corruptNoIndices);
+    checkCorrupted("index range", cacheData, cacheSize, corruptIndexRange);
+    checkCorrupted("index count", cacheData, cacheSize, corruptIndexCount);
+
+    free(cacheData);
+    mesh_FreeData(&mesh);
+    remove("test_mesh.obj");
+    remove("test_mesh.vkmesh");
+    remove("test_mesh_corrupted.vkmesh");
+
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// --------------------- Static Definitions ---------------------------------------------------------- //
+
+static void writeFile(const char *fileName, const void *data, size_t size) {
+    FILE *file = fopen(fileName, "wb");
+    if (!file || fwrite(data, 1, size, file) != size || fclose(file) != 0) {
+        perror(fileName);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void *readFile(const char *fileName, size_t *outSize) {
+    FILE *file = fopen(fileName, "rb");
+    if (!file) {
+        perror(fileName);
+        exit(EXIT_FAILURE);
+    }
+    fseek(file, 0, SEEK_END);
+    *outSize = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    void *data = malloc(*outSize);
+    if (!data || fread(data, 1, *outSize, file) != *outSize) {
+        perror(fileName);
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+    return data;
+}
+
+static bool opens(const char *fileName) {
+    MeshCache cache;
+    bool opened = meshCache_Open(fileName, &cache);
+    if (opened) {
+        meshCache_Close(&cache);
+    }
+    return opened;
+}
+
+// Writes a copy of the valid cache altered by corrupt, which must then be rejected
+static void checkCorrupted(const char *name, const uint8_t *cache, size_t cacheSize, void (*corrupt)(uint8_t *data, size_t *size)) {
+    uint8_t *data = (uint8_t *)malloc(cacheSize);
+    if (!data) {
+        perror("malloc fail in checkCorrupted");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(data, cache, cacheSize);
+
+    size_t size = cacheSize;
+    corrupt(data, &size);
+    writeFile("test_mesh_corrupted.vkmesh", data, size);
+    if (opens("test_mesh_corrupted.vkmesh")) {
+        fprintf(stderr, "corrupted cache (%s) was accepted\n", name);
+        failures++;
+    }
+    free(data);
+}
+
+static void corruptMagic(uint8_t *data, size_t *size) {
+    ((MeshCacheHeader *)data)->magic ^= 1;
+}
+
+static void corruptVersion(uint8_t *data, size_t *size) {
+    ((MeshCacheHeader *)data)->version = MESH_CACHE_VERSION + 1;
+}
+
+static void corruptStride(uint8_t *data, size_t *size) {
+    ((MeshCacheHeader *)data)->vertexStride = sizeof(Vertex) + 4;
+}
+
+static void corruptAlignment(uint8_t *data, size_t *size) {
+    ((MeshCacheHeader *)data)->indexOffset += 4;
+}
+
+static void corruptTruncate(uint8_t *data, size_t *size) {
+    *size -= sizeof(uint32_t);
+}
+
+static void corruptTruncateHeader(uint8_t *data, size_t *size) {
+    *size = sizeof(MeshCacheHeader) - 1;
+}
+
+static void corruptNoVertices(uint8_t *data, size_t *size) {
+    ((MeshCacheHeader *)data)->vertexCount = 0;
+}
+
+static void corruptNoIndices(uint8_t *data, size_t *size) {
+    ((MeshCacheHeader *)data)->indexCount = 0;
+}
+
+static void corruptIndexRange(uint8_t *data, size_t *size) {
+    const MeshCacheHeader *header = (const MeshCacheHeader *)data;
+    uint32_t *pIndices = (uint32_t *)(data + header->indexOffset);
+    pIndices[header->indexCount - 1] = (uint32_t)header->vertexCount;
+}
+
+static void corruptIndexCount(uint8_t *data, size_t *size) {
+    ((MeshCacheHeader *)data)->indexCount += 1;
+}
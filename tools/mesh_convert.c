@@ -0,0 +1,28 @@
+// Converts a Wavefront OBJ mesh into the binary cache format read by meshCache_Open, so loading it at runtime
+// is an mmap and a copy instead of a parse.
+
+#include <mesh.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s INPUT.obj OUTPUT.vkmesh\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    MeshData mesh;
+    mesh_LoadObj(argv[1], &mesh);
+    if (mesh.indexCount == 0) {
+        fprintf(stderr, "%s has no faces (only OBJ is supported)\n", argv[1]);
+        mesh_FreeData(&mesh);
+        return EXIT_FAILURE;
+    }
+
+    meshCache_Write(argv[2], &mesh);
+    fprintf(stderr, "%s: %u vertices, %u triangles\n", argv[2], mesh.vertexCount, mesh.indexCount / 3);
+
+    mesh_FreeData(&mesh);
+    return EXIT_SUCCESS;
+}